@@ -52,9 +52,14 @@ std::string generateMethodBody(std::string methodName, std::string className, co
         auto args = generateArgs(methodDecl);
 
         std::cout << "    method " << methodName << "(" << args << ") -> " << resultTypeName << std::endl;
-        //if (methodDecl->isConst()) {
-        methodConditionBlock << ".addFunction(\"" << methodName << "\", &" << className << "::" << methodName << ")" << std::endl;
-        //}
+        // Address of overloaded method is ambiguous, so it's casted to the exact signature
+        if (methods.size() > 1) {
+            methodConditionBlock << ".addFunction(\"" << methodName << "\", static_cast<"
+                                 << resultTypeName << " (" << className << "::*) (" << args << ")" << (methodDecl->isConst() ? " const" : "")
+                                 << ">(&" << className << "::" << methodName << "))" << std::endl;
+        } else {
+            methodConditionBlock << ".addFunction(\"" << methodName << "\", &" << className << "::" << methodName << ")" << std::endl;
+        }
     }
     return methodConditionBlock.str();
 }
@@ -12,13 +12,15 @@ GeneratorArgs::GeneratorArgs(const std::vector<std::string>& args) {
     const char* reflectionIncludes = "reflection-includes";
     const char* reflectionName = "reflection-name";
     const char* reflectionOut = "reflection-out";
+    const char* staticTables = "static-tables";
 
     options_description desc{"Options"};
     desc.add_options()
       (compiller, value<std::string>()->required())
       (reflectionIncludes, value<std::string>()->required())
       (reflectionName, value<std::string>())
-      (reflectionOut, value<std::string>());
+      (reflectionOut, value<std::string>())
+      (staticTables, bool_switch());
 
     variables_map vm;
     basic_command_line_parser parser{args};
@@ -59,5 +61,6 @@ GeneratorArgs::GeneratorArgs(const std::vector<std::string>& args) {
         m_reflectionName = vm[reflectionName].as<std::string>();
     else
         throw std::runtime_error("Reflection name is not defined");
-    
+
+    m_staticTables = vm[staticTables].as<bool>();
 }
@@ -12,6 +12,8 @@ public:
     const boost::filesystem::path& reflectionIncludesPath() const noexcept { return m_reflectionIncludesPath; }
     const boost::filesystem::path& reflectionOutPath() const noexcept { return m_reflectionOutPath; }
     const std::string& reflectionName() const noexcept { return m_reflectionName; }
+    // Emit constant type tables instead of registration code
+    bool staticTables() const noexcept { return m_staticTables; }
     
     const std::vector<std::string>& unrecognized() const noexcept { return m_unrecognized; }
     
@@ -20,5 +22,6 @@ private:
     boost::filesystem::path m_reflectionIncludesPath;
     boost::filesystem::path m_reflectionOutPath;
     std::string m_reflectionName;
+    bool m_staticTables = false;
     std::vector<std::string> m_unrecognized;
 };
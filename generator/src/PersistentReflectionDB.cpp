@@ -11,6 +11,8 @@ const char* cppFilePathKey = "cpp_file_path";
 const char* reflectedCppFilePathKey = "reflected_cpp_file_path";
 const char* outFilePathKey = "out_file_path";
 const char* functionNameKey = "function_name";
+const char* typeNamesKey = "type_names";
+const char* staticTableKey = "static_table";
 const char* jsonExtension = ".json";
 
 PersistentReflectionDB::PersistentReflectionDB(const boost::filesystem::path& reflectionDbFilePath)
@@ -32,6 +34,12 @@ static PersistentReflectionDB::ReflectedFile readReflectedFile(boost::filesystem
     reflectedFile.reflectedCppFilePath = reflectedFileData.get_child(reflectedCppFilePathKey).get_value<std::string>();
     reflectedFile.outFilePath = reflectedFileData.get_child(outFilePathKey).get_value<std::string>();
     reflectedFile.functionName = reflectedFileData.get_child(functionNameKey).get_value<std::string>();
+    // Files written by older generators have no type names
+    if (auto typeNames = reflectedFileData.get_child_optional(typeNamesKey)) {
+        for (const auto& typeName : *typeNames)
+            reflectedFile.typeNames.emplace_back(typeName.second.get_value<std::string>());
+    }
+    reflectedFile.staticTable = reflectedFileData.get<bool>(staticTableKey, false);
     
     return reflectedFile;
 }
@@ -69,6 +77,14 @@ void PersistentReflectionDB::addReflectedFile(const ReflectedFile& reflectedFile
     reflectedFileData.add(reflectedCppFilePathKey, reflectedFile.reflectedCppFilePath.string());
     reflectedFileData.add(outFilePathKey, reflectedFile.outFilePath.string());
     reflectedFileData.add(functionNameKey, reflectedFile.functionName);
+    property_tree::ptree typeNames;
+    for (const auto& typeName : reflectedFile.typeNames) {
+        property_tree::ptree typeNameData;
+        typeNameData.put_value(typeName);
+        typeNames.push_back(std::make_pair("", typeNameData));
+    }
+    reflectedFileData.add_child(typeNamesKey, typeNames);
+    reflectedFileData.add(staticTableKey, reflectedFile.staticTable);
     
     create_directories(m_reflectionDbFilePath);
     auto path = m_reflectionDbFilePath;
@@ -13,6 +13,9 @@ public:
         boost::filesystem::path reflectedCppFilePath;
         boost::filesystem::path outFilePath;
         std::string functionName;
+        std::vector<std::string> typeNames;
+        // Function name refers to a StaticTypeTable instead of a registration function
+        bool staticTable = false;
     };
     
     std::vector<ReflectedFile> reflectedFiles() const;
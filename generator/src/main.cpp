@@ -26,6 +26,9 @@
 #include "PersistentReflectionDB.hpp"
 #include "CompilerInfo.hpp"
 
+#include <PerfectHash.hpp>
+#include <TypeId.hpp>
+
 using namespace boost;
 using namespace std;
 using namespace llvm;
@@ -72,8 +75,11 @@ std::string generateWrapperCpp(ReflectionUnit reflectionUnit) {
     ss << std::endl;
     ss << "void " << reflectionUnit.name << "(mojito::Reflection& reflection) {" << std::endl;
     for (const auto& type : reflectionUnit.reflectedTypes) {
-        ss << "  reflection.registerType<" << type.typeName << ">(\"" << type.typeName  << "\")" << std::endl;
+        // Members are added before the type is published
+        ss << "  reflection.registerType<" << type.typeName << ">(\"" << type.typeName  << "\", [] (Type& type) {" << std::endl;
+        ss << "    type" << std::endl;
         ss << type.methods.methodBodies << ";" << std::endl;
+        ss << "  });" << std::endl;
     }
     ss << "}" << std::endl;
     ss << std::endl;
@@ -81,6 +87,37 @@ std::string generateWrapperCpp(ReflectionUnit reflectionUnit) {
     return ss.str();
 }
 
+// Same types as constant table, that is adopted by the reflection with Reflection::adoptTypeTable()
+std::string generateStaticTableCpp(ReflectionUnit reflectionUnit) {
+    std::stringstream ss;
+    
+    ss << "#include <" << reflectionUnit.originalPath.string() << ">" << std::endl;
+    ss << "#include <Type.hpp>" << std::endl;
+    ss << "#include <StaticTypeTable.hpp>" << std::endl;
+    ss << "#include <BasicTypesReflection.hpp>" << std::endl;
+    ss << std::endl;
+    ss << "using namespace mojito;" << std::endl;
+    ss << std::endl;
+    for (size_t i = 0; i < reflectionUnit.reflectedTypes.size(); ++i) {
+        ss << "static void addMembers" << i << "(Type& type) {" << std::endl;
+        ss << "  type" << std::endl;
+        ss << reflectionUnit.reflectedTypes[i].methods.methodBodies << ";" << std::endl;
+        ss << "}" << std::endl;
+        ss << std::endl;
+    }
+    ss << "static constexpr StaticTypeInfo types[] = {" << std::endl;
+    for (size_t i = 0; i < reflectionUnit.reflectedTypes.size(); ++i) {
+        const auto& typeName = reflectionUnit.reflectedTypes[i].typeName;
+        ss << "    { \"" << typeName << "\", &getTypeId<" << typeName << ">, &addMembers" << i << " }," << std::endl;
+    }
+    ss << "};" << std::endl;
+    ss << std::endl;
+    // Constant initialized, as the initializer is a constant expression
+    ss << "extern const StaticTypeTable " << reflectionUnit.name << " { types, " << reflectionUnit.reflectedTypes.size() << " };" << std::endl;
+    
+    return ss.str();
+}
+
 void writeTextFile(const filesystem::path& filePath, const std::string& data) {
     std::ofstream textFile;
     textFile.open(filePath.string());
@@ -187,6 +224,32 @@ std::string serializeCompillerArgs(const filesystem::path& compillerPath, const
     return ss.str();
 }
 
+// Constant name table with a minimal perfect hash over the names, see mojito::NameTable
+std::string generateNameTable(const std::vector<std::string>& names) {
+    std::vector<uint64_t> hashes;
+    for (const auto& name : names)
+        hashes.push_back(mojito::typeNameHash(name));
+    mojito::PerfectHash perfectHash(hashes);
+    std::vector<const std::string*> slots(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+        slots[perfectHash.slot(hashes[i])] = &names[i];
+
+    std::stringstream ss;
+    ss << "static constexpr uint32_t nameTableDisplacements[] = {";
+    for (auto displacement : perfectHash.displacements())
+        ss << displacement << "u, ";
+    ss << "};" << std::endl;
+    ss << "static constexpr std::string_view nameTableNames[] = {" << std::endl;
+    for (auto name : slots)
+        ss << "    \"" << *name << "\"," << std::endl;
+    ss << "};" << std::endl;
+    ss << "static constexpr NameTable nameTable {" << std::endl;
+    ss << "    nameTableDisplacements, " << perfectHash.displacements().size() << "," << std::endl;
+    ss << "    nameTableNames, " << names.size() << std::endl;
+    ss << "};" << std::endl;
+    return ss.str();
+}
+
 std::string generateReflectionCpp(const PersistentReflectionDB& reflectionDB, const std::unordered_set<std::string>& outFiles) {
     std::stringstream ss;
     
@@ -195,18 +258,42 @@ std::string generateReflectionCpp(const PersistentReflectionDB& reflectionDB, co
         return filesystem::exists(file.cppFilePath) && outFiles.find(objName) != outFiles.end();
     };
     
-    ss << "namespace mojito { class Reflection; }" << std::endl;
+    // Names of all types linked into the binary, the same type may be reflected in several files
+    std::vector<std::string> typeNames;
+    std::unordered_set<std::string> uniqueTypeNames;
+    for (auto file : reflectionDB.reflectedFiles()) {
+        if (!isPresented(file))
+            continue;
+        for (const auto& typeName : file.typeNames) {
+            if (uniqueTypeNames.insert(typeName).second)
+                typeNames.push_back(typeName);
+        }
+    }
+    
+    ss << "#include <Reflection.hpp>" << std::endl;
+    ss << std::endl;
     ss << "using namespace mojito;" << std::endl;
     ss << std::endl;
     for (auto file : reflectionDB.reflectedFiles()) {
-        if (isPresented(file))
+        if (isPresented(file) && file.staticTable)
+            ss << "extern const StaticTypeTable " << file.functionName << ";" << std::endl;
+        else if (isPresented(file))
             ss << "extern void " << file.functionName << "(mojito::Reflection&);" << std::endl;
     }
     ss << std::endl;
+    if (!typeNames.empty()) {
+        ss << generateNameTable(typeNames);
+        ss << std::endl;
+    }
     ss << "bool generateReflection(Reflection& reflectionDB) {" << std::endl;
     
+    if (!typeNames.empty())
+        ss << "    reflectionDB.setNameTable(nameTable);" << std::endl;
+    
     for (auto file : reflectionDB.reflectedFiles()) {
-        if (isPresented(file))
+        if (isPresented(file) && file.staticTable)
+            ss << "    reflectionDB.adoptTypeTable(" << file.functionName << ");" << std::endl;
+        else if (isPresented(file))
             ss << "    " << file.functionName << "(reflectionDB);" << std::endl;
     }
     
@@ -328,12 +415,20 @@ int main(int argc, const char *argv[])
             *found = cppFile.first;
             std::cout << "generated " << filesystem::path(cppFile.first).parent_path() << std::endl;
             filesystem::create_directories(filesystem::path(cppFile.first).parent_path());
-            writeTextFile(cppFile.first, generateWrapperCpp(cppFile.second));
+            if (generatorArgs.staticTables())
+                writeTextFile(cppFile.first, generateStaticTableCpp(cppFile.second));
+            else
+                writeTextFile(cppFile.first, generateWrapperCpp(cppFile.second));
+            std::vector<std::string> typeNames;
+            for (const auto& type : cppFile.second.reflectedTypes)
+                typeNames.push_back(type.typeName);
             reflectionDB.addReflectedFile({
                 .cppFilePath = cppFile.second.originalPath,
                 .reflectedCppFilePath = cppFile.first,
                 .outFilePath = compillerArgs.output(),
-                .functionName = cppFile.second.name
+                .functionName = cppFile.second.name,
+                .typeNames = typeNames,
+                .staticTable = generatorArgs.staticTables()
             });
         }
         
@@ -350,6 +445,7 @@ int main(int argc, const char *argv[])
         filesystem::create_directories(reflectionCppPath.parent_path());
         writeTextFile(reflectionCppPath, reflectionCppData);
         compillerArgs.addCppInputFile(reflectionCppPath);
+        compillerArgs.addIncludePath(generatorArgs.reflectionIncludesPath());
         filesystem::create_directories(reflectionCppPath.parent_path());
     }
 
@@ -13,29 +13,31 @@ class Reflection;
 class AnyArg {
 public:
     AnyArg() = default;
-    AnyArg(const AnyArg&) = default; // FIXME: Remove copy constructor
-    AnyArg(AnyArg&&) = default;
 
-    template <typename T>
-    AnyArg(T&& value, std::enable_if_t<!std::is_convertible_v<T, ValueRef> && !std::is_rvalue_reference_v<T&&>>* = 0)
-        : m_valueRef(value)
+    AnyArg(const AnyArg& other)
+        : m_pointer(other.m_pointer)
+        , m_valueRef(other.storesPointer() ? ValueRef(&m_pointer, other.m_valueRef.typeId()) : other.m_valueRef)
+        , m_temporary(other.m_temporary)
     {}
 
-    template <typename T>
-    AnyArg (T&& value, std::enable_if_t<!std::is_convertible_v<T, ValueRef> && std::is_rvalue_reference_v<T&&>>* = 0)
-        : m_tmpValue(std::forward<T>(value))
-        , m_valueRef(*m_tmpValue)
+    AnyArg(AnyArg&& other)
+        : AnyArg(static_cast<const AnyArg&>(other))
     {}
 
+    AnyArg& operator=(const AnyArg&) = delete;
+
+    // Arguments are referenced in place, rvalues included. Function::operator() keeps them alive until the call returns.
     template <typename T>
     AnyArg (T&& value, std::enable_if_t<std::is_convertible_v<T, ValueRef>>* = 0)
         : m_valueRef(value)
+        , m_temporary(!std::is_lvalue_reference_v<T> && ownsObject(value))
     {}
 
+    // Pointer is kept inline, so ValueRef can point to it without boxing the pointer on the heap
     template <typename T>
     AnyArg (T* value)
-        : m_tmpValue(value)
-        , m_valueRef(*m_tmpValue)
+        : m_pointer(const_cast<std::remove_const_t<T>*>(value))
+        , m_valueRef(&m_pointer, getTypeId<T*>())
     {}
 
     AnyArg(void* valuePtr, TypeId typeId)
@@ -45,10 +47,10 @@ public:
     template <typename T>
     std::decay_t<T>& as(const Reflection& reflection) const {
         auto typeId = getTypeId<std::decay_t<T>>();
-        if (typeId != m_valueRef.typeId() && !(typeId.isPointer() && m_valueRef.typeId().isPointer())) {
+        if (!m_valueRef.typeId().canPassTo(typeId)) {
             try {
-                [this, &typeId](auto reflection) {
-                    m_constructedValue = reflection.getType(typeId).constructOnStack(*this);
+                [this, &typeId](const auto& reflection) {
+                    m_constructedValue = reflection.convert(*this, typeId);
                 } (reflection);
                 return m_constructedValue->as<std::decay_t<T>>();
             } catch (const std::exception& e) {
@@ -62,10 +64,38 @@ public:
 
     const ValueRef& valueRef() const { return m_valueRef; }
 
+    // Object of the argument doesn't outlive the call: it's a temporary, a converted value or the pointer kept inline
+    bool isTemporary() const noexcept { return m_temporary || m_constructedValue.has_value() || storesPointer(); }
+
 private:
-    std::optional<Value> m_tmpValue;
+    void* m_pointer = nullptr;
     ValueRef m_valueRef;
+    bool m_temporary = false;
     mutable std::optional<Value> m_constructedValue;
+
+    // Temporary ValueRef and reference Value refer to objects living elsewhere
+    template <typename T>
+    static bool ownsObject(const T& value) noexcept {
+        if constexpr (std::is_same_v<std::decay_t<T>, ValueRef>)
+            return false;
+        else if constexpr (std::is_same_v<std::decay_t<T>, Value>)
+            return !value.isReference();
+        else
+            return true;
+    }
+
+    bool storesPointer() const noexcept { return m_valueRef.voidPointer() == &m_pointer; }
 };
 
+// Type id of an argument passed to reflective call, that can be AnyArg, Value, ValueRef or any plain object
+template <typename ArgT>
+TypeId argumentTypeId(const ArgT& arg) {
+    if constexpr (std::is_same_v<std::decay_t<ArgT>, AnyArg>)
+        return arg.valueRef().typeId();
+    else if constexpr (std::is_convertible_v<std::decay_t<ArgT>&, ValueRef&>)
+        return arg.typeId();
+    else
+        return getTypeId<ArgT>();
+}
+
 } // mojito
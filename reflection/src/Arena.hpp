@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mojito {
+
+// Bump allocator. Objects are placed one after another in large blocks, so they have stable addresses and
+// metadata registered together stays close in memory. Nothing is freed separately, destructors run and memory
+// is released all at once with the arena. Not thread safe, the owner serializes allocations.
+class Arena {
+public:
+    Arena() = default;
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    // Objects are destroyed in reverse order of creation
+    ~Arena() {
+        for (auto iter = m_destructors.rbegin(); iter != m_destructors.rend(); ++iter)
+            iter->destroy(iter->object);
+    }
+
+    // Blocks are aligned for any fundamental type, so offsets are aligned relative to the block start
+    void* allocate(size_t size, size_t alignment) {
+        auto offset = (m_offset + alignment - 1) & ~(alignment - 1);
+        if (m_current == nullptr || offset + size > BlockSize) {
+            // Large objects get blocks of their own, so the current block keeps its free space
+            if (size > BlockSize / 4) {
+                m_blocks.push_back(std::make_unique<char[]>(size));
+                m_reservedBytes += size;
+                m_usedBytes += size;
+                return m_blocks.back().get();
+            }
+            m_blocks.push_back(std::make_unique<char[]>(BlockSize));
+            m_current = m_blocks.back().get();
+            m_reservedBytes += BlockSize;
+            offset = 0;
+        }
+        m_offset = offset + size;
+        m_usedBytes += size;
+        return m_current + offset;
+    }
+
+    template <typename T, typename ... ArgT>
+    T* create(ArgT&& ... args) {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+        // Reserved before construction, so the object is never left without its destructor
+        if (!std::is_trivially_destructible<T>::value && m_destructors.size() == m_destructors.capacity())
+            m_destructors.reserve(std::max<size_t>(MinDestructorsCapacity, m_destructors.capacity() * 2));
+        auto object = new (allocate(sizeof(T), alignof(T))) T(std::forward<ArgT>(args)...);
+        if constexpr (!std::is_trivially_destructible<T>::value)
+            m_destructors.push_back({ object, [] (void* object) { static_cast<T*>(object)->~T(); } });
+        return object;
+    }
+
+    // Bytes taken by objects, without alignment padding and unused space at ends of blocks
+    size_t usedBytes() const noexcept { return m_usedBytes; }
+
+    // Bytes of all blocks and of the destructors list
+    size_t reservedBytes() const noexcept { return m_reservedBytes + m_destructors.capacity() * sizeof(Destructor); }
+
+private:
+    static constexpr size_t BlockSize = 16 * 1024;
+    static constexpr size_t MinDestructorsCapacity = 64;
+
+    struct Destructor {
+        void* object;
+        void (*destroy) (void* object);
+    };
+
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    std::vector<Destructor> m_destructors;
+    char* m_current = nullptr;
+    size_t m_offset = 0;
+    size_t m_usedBytes = 0;
+    size_t m_reservedBytes = 0;
+};
+
+} // mojito
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "AnyArg.hpp"
+
+namespace mojito {
+
+// Non-owning view over arguments of a single reflective call.
+// Arguments themselves live in a fixed size array on the caller's stack, so passing them doesn't allocate.
+class ArgFrame {
+public:
+    ArgFrame(const AnyArg* args, size_t size) noexcept
+        : m_args(args)
+        , m_size(size)
+    {}
+
+    template <size_t Size>
+    ArgFrame(const std::array<AnyArg, Size>& args) noexcept
+        : ArgFrame(args.data(), Size)
+    {}
+
+    size_t size() const noexcept { return m_size; }
+
+    const AnyArg& operator[](size_t index) const noexcept { return m_args[index]; }
+
+    const AnyArg& front() const noexcept { return m_args[0]; }
+
+    const AnyArg* begin() const noexcept { return m_args; }
+
+    const AnyArg* end() const noexcept { return m_args + m_size; }
+
+private:
+    const AnyArg* m_args;
+    size_t m_size;
+};
+
+} // mojito
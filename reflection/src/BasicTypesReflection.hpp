@@ -14,11 +14,12 @@ public:
         return standardTypesReflection;
     }
     BasicTypesReflection() : m_reflection(std::make_shared<Reflection>()) {
-        m_reflection->registerType<std::string>("std::string")
-                    .addConstructor<std::string, const char*>()
-                    .addConstructor<std::string, std::string>()
-                    .addConstructor<std::string, size_t, char>()
-                    .addFunction<std::string, unsigned long>("capacity", [](auto obj){ return obj.capacity(); } );
+        m_reflection->registerType<std::string>("std::string", [] (Type& type) {
+            type.addConstructor<std::string, const char*>()
+                .addConstructor<std::string, std::string>()
+                .addConstructor<std::string, size_t, char>()
+                .addFunction<std::string, unsigned long>("capacity", [](auto obj){ return obj.capacity(); } );
+        });
     }
 
     const std::shared_ptr<Reflection>& reflection() const { return m_reflection; }
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "TypeId.hpp"
+
+namespace mojito {
+
+class UnknownClass;
+
+// Function pointer, member function pointer or captures of a lambda erased to a common type. Only the thunk
+// created together with it knows the original type, so it's the only one allowed to cast it back.
+union Callable {
+    void (*function)();
+    // Member function pointers can't be cast to one type without -Wcast-function-type warnings, so they are
+    // copied as bytes, as well as lambda captures. Pointer to member of an incomplete class has the largest
+    // representation on all ABIs.
+    alignas(void (UnknownClass::*)()) unsigned char storage[sizeof(void (UnknownClass::*)())];
+
+    template <typename MemberFunctionT>
+    static Callable fromMemberFunction(MemberFunctionT func) noexcept {
+        static_assert(sizeof(MemberFunctionT) <= sizeof(storage), "Member function pointer doesn't fit");
+        Callable callable {};
+        std::memcpy(callable.storage, &func, sizeof(func));
+        return callable;
+    }
+
+    template <typename MemberFunctionT>
+    MemberFunctionT toMemberFunction() const noexcept {
+        MemberFunctionT func;
+        std::memcpy(&func, storage, sizeof(func));
+        return func;
+    }
+
+    // Lambda is copied as bytes with the callable, so it has to be trivially copyable
+    template <typename LambdaT>
+    static Callable fromLambda(const LambdaT& lambda) noexcept {
+        static_assert(std::is_trivially_copyable_v<LambdaT>, "Lambda captures must be trivially copyable");
+        static_assert(sizeof(LambdaT) <= sizeof(storage) && alignof(LambdaT) <= alignof(Callable),
+                      "Lambda captures must fit in the size of a member function pointer");
+        Callable callable {};
+        std::memcpy(callable.storage, &lambda, sizeof(lambda));
+        return callable;
+    }
+
+    template <typename LambdaT>
+    const LambdaT& toLambda() const noexcept {
+        return *std::launder(reinterpret_cast<const LambdaT*>(storage));
+    }
+};
+
+template <typename SignatureT>
+class BoundFunction;
+
+// Typed handle to a reflected function, returned by Function::bind().
+// Signature is checked once on binding, so calls skip argument conversion, Value boxing and type checks.
+// Handle keeps a copy of the function pointer, so it doesn't depend on lifetime of the Function it was bound from.
+template <typename ResultT, typename ... ArgT>
+class BoundFunction<ResultT(ArgT...)> {
+public:
+    using Thunk = ResultT (*) (const Callable& callable, ArgT ... args);
+
+    BoundFunction(Thunk thunk, const Callable& callable) noexcept
+        : m_thunk(thunk)
+        , m_callable(callable)
+    {}
+
+    ResultT operator()(ArgT ... args) const {
+        return m_thunk(m_callable, std::forward<ArgT>(args) ...);
+    }
+
+    static TypeId resultTypeId() { return getTypeId<ResultT>(); }
+
+    static std::vector<TypeId> argumentTypeIds() { return {getTypeId<ArgT>()...}; }
+
+private:
+    Thunk m_thunk;
+    Callable m_callable;
+};
+
+} // mojito
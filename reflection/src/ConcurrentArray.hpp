@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+
+namespace mojito {
+
+// Sparse array of pointers with lock-free reads. Storage grows by segments of doubling size, that are never
+// moved, so a concurrent read never sees reallocated memory. Stores should be serialized by the owner.
+template <typename T>
+class ConcurrentArray {
+public:
+    ConcurrentArray() = default;
+
+    ConcurrentArray(const ConcurrentArray&) = delete;
+
+    ConcurrentArray& operator=(const ConcurrentArray&) = delete;
+
+    ~ConcurrentArray() {
+        for (auto& segment : m_segments)
+            delete[] segment.load(std::memory_order_relaxed);
+    }
+
+    // Returns nullptr for indices that were never stored
+    T* load(size_t index) const noexcept {
+        size_t segment, offset;
+        locate(index, segment, offset);
+        if (segment >= SegmentsCount)
+            return nullptr;
+        auto data = m_segments[segment].load(std::memory_order_acquire);
+        return data != nullptr ? data[offset].load(std::memory_order_acquire) : nullptr;
+    }
+
+    void store(size_t index, T* value) {
+        size_t segment, offset;
+        locate(index, segment, offset);
+        if (segment >= SegmentsCount)
+            throw std::out_of_range("ConcurrentArray::store");
+        auto data = m_segments[segment].load(std::memory_order_relaxed);
+        if (data == nullptr) {
+            data = new std::atomic<T*>[FirstSegmentSize << segment]();
+            m_segments[segment].store(data, std::memory_order_release);
+        }
+        data[offset].store(value, std::memory_order_release);
+        if (index >= m_size.load(std::memory_order_relaxed))
+            m_size.store(index + 1, std::memory_order_release);
+    }
+
+    // Largest stored index plus one
+    size_t size() const noexcept { return m_size.load(std::memory_order_acquire); }
+
+    // Bytes of allocated segments
+    size_t memoryBytes() const noexcept {
+        size_t bytes = 0;
+        for (size_t segment = 0; segment < SegmentsCount; ++segment) {
+            if (m_segments[segment].load(std::memory_order_relaxed) != nullptr)
+                bytes += (FirstSegmentSize << segment) * sizeof(std::atomic<T*>);
+        }
+        return bytes;
+    }
+
+private:
+    static constexpr size_t FirstSegmentSize = 64;
+    static constexpr size_t SegmentsCount = 32;
+
+    std::atomic<std::atomic<T*>*> m_segments[SegmentsCount] {};
+    std::atomic<size_t> m_size {0};
+
+    // Segment k starts at FirstSegmentSize * (2^k - 1) and holds FirstSegmentSize * 2^k elements
+    static void locate(size_t index, size_t& segment, size_t& offset) noexcept {
+        size_t blocks = index / FirstSegmentSize + 1;
+        segment = 0;
+        while (blocks >>= 1)
+            ++segment;
+        offset = index - FirstSegmentSize * ((size_t(1) << segment) - 1);
+    }
+};
+
+} // mojito
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mojito {
+
+// Insert-only hash map with lock-free lookups. Inserts are serialized with a mutex. Entries are never moved
+// or removed, and grown tables are published with an atomic pointer while old ones are kept until destruction,
+// so a concurrent lookup never reads freed memory. Old tables take at most as much memory as the current one.
+template <typename KeyT, typename ValueT, typename HashT = std::hash<KeyT>>
+class ConcurrentMap {
+    using Entry = std::pair<KeyT, ValueT>;
+
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+    };
+
+public:
+    ConcurrentMap() = default;
+
+    ConcurrentMap(const ConcurrentMap&) = delete;
+
+    ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+    // Lock-free, returns nullptr if there is no such key
+    const ValueT* find(const KeyT& key) const noexcept {
+        auto table = m_table.load(std::memory_order_acquire);
+        if (table == nullptr)
+            return nullptr;
+        for (auto index = slotIndex(key, table->mask); ; index = (index + 1) & table->mask) {
+            auto entry = table->slots[index].load(std::memory_order_acquire);
+            if (entry == nullptr)
+                return nullptr;
+            if (entry->first == key)
+                return &entry->second;
+        }
+    }
+
+    // Doesn't overwrite existing entry. Returns the stored value and whether it was inserted.
+    std::pair<const ValueT*, bool> insert(const KeyT& key, ValueT value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto existing = find(key))
+            return { existing, false };
+        auto table = m_table.load(std::memory_order_relaxed);
+        if (table == nullptr || (m_entries.size() + 1) * 2 > table->mask + 1)
+            table = grow(table == nullptr ? MinCapacity : (table->mask + 1) * 2);
+        m_entries.emplace_back(key, std::move(value));
+        place(*table, &m_entries.back());
+        return { &m_entries.back().second, true };
+    }
+
+    // Bytes of entries and of all tables, including the outdated ones. Memory owned by keys and values is not included.
+    size_t memoryBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t bytes = m_entries.size() * sizeof(Entry) + m_tables.capacity() * sizeof(std::unique_ptr<Table>);
+        for (const auto& table : m_tables)
+            bytes += sizeof(Table) + (table->mask + 1) * sizeof(std::atomic<const Entry*>);
+        return bytes;
+    }
+
+    // Visits entries in order of insertion. Takes the lock, so it's not for hot paths.
+    template <typename FuncT>
+    void forEach(FuncT func) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_entries)
+            func(entry.first, entry.second);
+    }
+
+private:
+    static constexpr size_t MinCapacity = 16;
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_entries;
+    // Current table is the last one, previous ones may still be read by lookups
+    std::vector<std::unique_ptr<Table>> m_tables;
+    std::atomic<Table*> m_table {nullptr};
+
+    static size_t slotIndex(const KeyT& key, size_t mask) noexcept {
+        auto hash = static_cast<uint64_t>(HashT()(key)) * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash >> 32) & mask;
+    }
+
+    static void place(Table& table, const Entry* entry) noexcept {
+        auto index = slotIndex(entry->first, table.mask);
+        while (table.slots[index].load(std::memory_order_relaxed) != nullptr)
+            index = (index + 1) & table.mask;
+        table.slots[index].store(entry, std::memory_order_release);
+    }
+
+    Table* grow(size_t capacity) {
+        auto table = std::make_unique<Table>();
+        table->mask = capacity - 1;
+        table->slots.reset(new std::atomic<const Entry*>[capacity]());
+        for (const auto& entry : m_entries)
+            place(*table, &entry);
+        m_tables.push_back(std::move(table));
+        m_table.store(m_tables.back().get(), std::memory_order_release);
+        return m_tables.back().get();
+    }
+};
+
+} // mojito
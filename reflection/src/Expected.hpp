@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+
+#include "TypeId.hpp"
+
+namespace mojito {
+
+enum class ErrorCode : uint8_t {
+    WrongArgumentsNumber,
+    NoConversion,
+    NoConstructor,
+    NoOverload
+};
+
+// Error of a non-throwing call. Only the code and the context are stored, message is formatted on demand.
+class Error {
+public:
+    Error(ErrorCode code) noexcept
+        : m_code(code)
+    {}
+
+    static Error wrongArgumentsNumber(size_t expected, size_t received) noexcept {
+        Error error(ErrorCode::WrongArgumentsNumber);
+        error.m_expected = expected;
+        error.m_received = received;
+        return error;
+    }
+
+    static Error noConversion(TypeId sourceTypeId, TypeId targetTypeId) noexcept {
+        Error error(ErrorCode::NoConversion);
+        error.m_sourceTypeId = sourceTypeId;
+        error.m_targetTypeId = targetTypeId;
+        return error;
+    }
+
+    ErrorCode code() const noexcept { return m_code; }
+
+    std::string message() const {
+        switch (m_code) {
+            case ErrorCode::WrongArgumentsNumber:
+                return concat("Wrong number of arguments. Expected: ", m_expected, " Received: ", m_received);
+            case ErrorCode::NoConversion:
+                return concat("No convertion to type ", getTypeName(m_targetTypeId), " from type ", getTypeName(m_sourceTypeId));
+            case ErrorCode::NoConstructor:
+                return "Can't construct";
+            case ErrorCode::NoOverload:
+                return "No overload matches the arguments";
+        }
+        return "Unknown error";
+    }
+
+private:
+    ErrorCode m_code;
+    size_t m_expected = 0;
+    size_t m_received = 0;
+    TypeId m_sourceTypeId;
+    TypeId m_targetTypeId;
+};
+
+// Result of a non-throwing call, either a value or an error
+template <typename T>
+class Expected {
+public:
+    Expected(T value)
+        : m_storage(std::move(value))
+    {}
+
+    Expected(Error error)
+        : m_storage(std::move(error))
+    {}
+
+    bool hasValue() const noexcept { return m_storage.index() == 0; }
+
+    explicit operator bool() const noexcept { return hasValue(); }
+
+    T& value() {
+        if (!hasValue())
+            throw MojitoException(error().message());
+        return std::get<0>(m_storage);
+    }
+
+    const T& value() const {
+        if (!hasValue())
+            throw MojitoException(error().message());
+        return std::get<0>(m_storage);
+    }
+
+    T& operator*() { return value(); }
+
+    T* operator->() { return &value(); }
+
+    const Error& error() const { return std::get<1>(m_storage); }
+
+private:
+    std::variant<T, Error> m_storage;
+};
+
+} // mojito
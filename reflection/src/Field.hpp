@@ -14,22 +14,37 @@ public:
     template <typename TypeT, typename FieldT>
     Field(const Reflection& reflection, FieldT TypeT::*fieldPtr)
         : m_typeId(getTypeId<FieldT>())
-        , m_setter([fieldPtr, &reflection](ValueRef& obj, const AnyArg& anyArg)
-            { reinterpret_cast<TypeT*>(obj.voidPointer())->*fieldPtr = anyArg.as<FieldT>(reflection); })
-        , m_getter([fieldPtr](const ValueRef& obj)
-            { return Value(reinterpret_cast<TypeT*>(obj.voidPointer())->*fieldPtr); })
+        , m_reflection(&reflection)
+        , m_fieldPtr(reinterpret_cast<char UnknownClass::*>(fieldPtr))
+        , m_setter(&setter<TypeT, FieldT>)
+        , m_getter(&getter<TypeT, FieldT>)
     {}
 
     const TypeId& typeId() const { return m_typeId; }
 
-    void setValue(ValueRef& obj, const AnyArg& anyValue) const { m_setter(obj, anyValue); }
+    void setValue(ValueRef& obj, const AnyArg& anyValue) const { m_setter(*this, obj, anyValue); }
 
-    Value getValue(const ValueRef& obj) const { return m_getter(obj); }
+    Value getValue(const ValueRef& obj) const { return m_getter(*this, obj); }
 
 private:
     TypeId m_typeId;
-    std::function<void(ValueRef&, const AnyArg&)> m_setter;
-    std::function<Value(const ValueRef&)> m_getter;
+    const Reflection* m_reflection;
+    // Field pointer erased to a common type, only setter and getter know the original one
+    char UnknownClass::* m_fieldPtr;
+    void (*m_setter) (const Field& field, ValueRef& obj, const AnyArg& anyArg);
+    Value (*m_getter) (const Field& field, const ValueRef& obj);
+
+    template <typename TypeT, typename FieldT>
+    static void setter(const Field& field, ValueRef& obj, const AnyArg& anyArg) {
+        auto fieldPtr = reinterpret_cast<FieldT TypeT::*>(field.m_fieldPtr);
+        reinterpret_cast<TypeT*>(obj.voidPointer())->*fieldPtr = anyArg.as<FieldT>(*field.m_reflection);
+    }
+
+    template <typename TypeT, typename FieldT>
+    static Value getter(const Field& field, const ValueRef& obj) {
+        auto fieldPtr = reinterpret_cast<FieldT TypeT::*>(field.m_fieldPtr);
+        return Value(reinterpret_cast<TypeT*>(obj.voidPointer())->*fieldPtr);
+    }
 };
 
 } // mojito
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Field.hpp"
+
+namespace mojito {
+
+// Field of a type resolved once by name with Type::fieldHandle(). Valid as long as the type it was resolved from.
+class FieldHandle {
+    friend class Type; // To construct
+public:
+    FieldHandle() = default;
+
+    explicit operator bool() const noexcept { return m_field != nullptr; }
+
+    const Field& field() const { return *m_field; }
+
+    const TypeId& typeId() const { return m_field->typeId(); }
+
+    void setValue(ValueRef& obj, const AnyArg& anyValue) const { m_field->setValue(obj, anyValue); }
+
+    Value getValue(const ValueRef& obj) const { return m_field->getValue(obj); }
+
+    bool operator==(const FieldHandle& other) const noexcept { return m_field == other.m_field; }
+
+    bool operator!=(const FieldHandle& other) const noexcept { return m_field != other.m_field; }
+
+private:
+    const Field* m_field = nullptr;
+
+    explicit FieldHandle(const Field* field) noexcept
+        : m_field(field)
+    {}
+};
+
+} // mojito
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace mojito {
+
+// Hash map with open addressing and linear probing. Entries are stored inline in a single array, so a lookup
+// touches one or two cache lines instead of following node pointers. Hashes are mixed once more before use,
+// so weak hashes (like aligned addresses) don't cluster. Erase is not supported, registries only grow.
+// Rehashing moves entries, so don't keep pointers to them, store stable pointers or indices as values instead.
+template <typename KeyT, typename ValueT, typename HashT = std::hash<KeyT>>
+class FlatMap {
+    struct Slot {
+        std::pair<KeyT, ValueT> entry;
+        bool used = false;
+    };
+
+    template <typename SlotT, typename EntryT>
+    class Iterator {
+    public:
+        Iterator(SlotT* slot, SlotT* end) noexcept
+            : m_slot(slot)
+            , m_end(end)
+        {
+            skipUnused();
+        }
+
+        EntryT& operator*() const noexcept { return m_slot->entry; }
+
+        EntryT* operator->() const noexcept { return &m_slot->entry; }
+
+        Iterator& operator++() noexcept {
+            ++m_slot;
+            skipUnused();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const noexcept { return m_slot == other.m_slot; }
+
+        bool operator!=(const Iterator& other) const noexcept { return m_slot != other.m_slot; }
+
+    private:
+        SlotT* m_slot;
+        SlotT* m_end;
+
+        void skipUnused() noexcept {
+            while (m_slot != m_end && !m_slot->used)
+                ++m_slot;
+        }
+    };
+
+public:
+    using value_type = std::pair<KeyT, ValueT>;
+    using iterator = Iterator<Slot, value_type>;
+    using const_iterator = Iterator<const Slot, const value_type>;
+
+    size_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    iterator begin() noexcept { return iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+
+    iterator end() noexcept { return iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+    const_iterator begin() const noexcept { return const_iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+
+    const_iterator end() const noexcept { return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+    iterator find(const KeyT& key) noexcept {
+        auto index = findIndex(key);
+        return index != NotFound ? iterator(&m_slots[index], m_slots.data() + m_slots.size()) : end();
+    }
+
+    const_iterator find(const KeyT& key) const noexcept {
+        auto index = findIndex(key);
+        return index != NotFound ? const_iterator(&m_slots[index], m_slots.data() + m_slots.size()) : end();
+    }
+
+    ValueT& at(const KeyT& key) {
+        auto index = findIndex(key);
+        if (index == NotFound)
+            throw std::out_of_range("FlatMap::at");
+        return m_slots[index].entry.second;
+    }
+
+    const ValueT& at(const KeyT& key) const {
+        auto index = findIndex(key);
+        if (index == NotFound)
+            throw std::out_of_range("FlatMap::at");
+        return m_slots[index].entry.second;
+    }
+
+    // Doesn't overwrite existing entry, as std::unordered_map::emplace
+    std::pair<iterator, bool> emplace(const KeyT& key, ValueT value) {
+        if ((m_size + 1) * 4 > m_slots.size() * 3)
+            rehash(m_slots.empty() ? MinCapacity : m_slots.size() * 2);
+        auto index = probe(key);
+        auto& slot = m_slots[index];
+        bool inserted = !slot.used;
+        if (inserted) {
+            slot.entry = value_type(key, std::move(value));
+            slot.used = true;
+            ++m_size;
+        }
+        return { iterator(&slot, m_slots.data() + m_slots.size()), inserted };
+    }
+
+    ValueT& operator[](const KeyT& key) {
+        return emplace(key, ValueT()).first->second;
+    }
+
+    // Bytes of the slots array
+    size_t memoryBytes() const noexcept { return m_slots.capacity() * sizeof(Slot); }
+
+    void reserve(size_t size) {
+        size_t capacity = MinCapacity;
+        while (capacity * 3 < size * 4)
+            capacity *= 2;
+        if (capacity > m_slots.size())
+            rehash(capacity);
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+private:
+    static constexpr size_t MinCapacity = 8;
+    static constexpr size_t NotFound = ~size_t(0);
+
+    std::vector<Slot> m_slots;
+    size_t m_size = 0;
+
+    // Fibonacci hashing, spreads entropy of any bits of the hash over the high bits used as the index
+    size_t slotIndex(const KeyT& key) const noexcept {
+        auto hash = static_cast<uint64_t>(HashT()(key)) * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash >> 32) & (m_slots.size() - 1);
+    }
+
+    // Index of the slot holding the key or of the free slot where it should be inserted
+    size_t probe(const KeyT& key) const noexcept {
+        auto mask = m_slots.size() - 1;
+        auto index = slotIndex(key);
+        while (m_slots[index].used && !(m_slots[index].entry.first == key))
+            index = (index + 1) & mask;
+        return index;
+    }
+
+    size_t findIndex(const KeyT& key) const noexcept {
+        if (m_slots.empty())
+            return NotFound;
+        auto index = probe(key);
+        return m_slots[index].used ? index : NotFound;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> slots(capacity);
+        std::swap(slots, m_slots);
+        for (auto& slot : slots) {
+            if (slot.used)
+                m_slots[probe(slot.entry.first)] = std::move(slot);
+        }
+    }
+};
+
+} // mojito
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "OverloadSet.hpp"
+
+namespace mojito {
+
+// Overloads of a method stored in a frozen snapshot, see FrozenReflection::method(). Overloads are resolved
+// on each call without caching, so calls don't write anything. Valid as long as the snapshot.
+class FrozenMethod {
+    friend class FrozenReflection; // To construct
+public:
+    FrozenMethod() = default;
+
+    explicit operator bool() const noexcept { return m_overloads != nullptr; }
+
+    size_t size() const noexcept { return m_overloadsCount; }
+
+    const Function& operator[](size_t index) const { return m_overloads[index]; }
+
+    template <typename ... ArgT>
+    Value operator()(ArgT&& ... anyArgs) const {
+        if (m_overloadsCount == 1)
+            return m_overloads[0](std::forward<ArgT>(anyArgs)...);
+        if (auto function = tryResolve(anyArgs...))
+            return (*function)(std::forward<ArgT>(anyArgs)...);
+        throw MojitoException("No overload matches the arguments");
+    }
+
+    // Non-throwing call, see Function::tryInvoke()
+    template <typename ... ArgT>
+    Expected<Value> tryInvoke(ArgT&& ... anyArgs) const {
+        if (m_overloadsCount == 1)
+            return m_overloads[0].tryInvoke(std::forward<ArgT>(anyArgs)...);
+        auto function = tryResolve(anyArgs...);
+        if (function == nullptr)
+            return Error(ErrorCode::NoOverload);
+        return function->tryInvoke(std::forward<ArgT>(anyArgs)...);
+    }
+
+    bool operator==(const FrozenMethod& other) const noexcept { return m_overloads == other.m_overloads; }
+
+    bool operator!=(const FrozenMethod& other) const noexcept { return m_overloads != other.m_overloads; }
+
+private:
+    const Function* m_overloads = nullptr;
+    size_t m_overloadsCount = 0;
+
+    FrozenMethod(const Function* overloads, size_t overloadsCount) noexcept
+        : m_overloads(overloads)
+        , m_overloadsCount(overloadsCount)
+    {}
+
+    template <typename ... ArgT>
+    const Function* tryResolve(const ArgT& ... anyArgs) const {
+        const std::array<TypeId, sizeof...(ArgT)> argumentTypeIds {argumentTypeId(anyArgs)...};
+        auto index = findOverload(m_overloads, m_overloadsCount, argumentTypeIds);
+        return index != m_overloadsCount ? &m_overloads[index] : nullptr;
+    }
+};
+
+} // mojito
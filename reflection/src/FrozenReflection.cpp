@@ -0,0 +1,210 @@
+#include "FrozenReflection.hpp"
+
+#include <unordered_map>
+
+#include "Reflection.hpp"
+
+namespace mojito {
+
+    FrozenReflection::FrozenReflection(std::shared_ptr<const Reflection> reflection)
+        : m_reflection(std::move(reflection))
+    {
+        // Entries of derived reflections shadow the base ones, as in lookups of Reflection
+        std::vector<std::pair<Symbol, const Type*>> namedTypes;
+        std::vector<std::pair<Symbol, const Function*>> namedFunctions;
+        std::vector<const Type*> typesByIndex;
+        for (auto level = m_reflection.get(); level != nullptr; level = level->m_baseReflection.get()) {
+            level->m_typesMap.forEach([this, &namedTypes] (Symbol name, const Type* type) {
+                if (m_reflection->findType(name) == type)
+                    namedTypes.emplace_back(name, type);
+            });
+            level->m_functionMap.forEach([this, &namedFunctions] (Symbol name, const Function* function) {
+                if (m_reflection->findFunction(name) == function)
+                    namedFunctions.emplace_back(name, function);
+            });
+            const auto& levelTypes = level->m_typesByIndex;
+            typesByIndex.resize(std::max(typesByIndex.size(), levelTypes.size()), nullptr);
+            for (size_t i = 0; i < levelTypes.size(); ++i) {
+                if (typesByIndex[i] == nullptr)
+                    typesByIndex[i] = levelTypes.load(i);
+            }
+        }
+
+        // Each type is listed once, even if it's reachable both by name and by type id
+        std::unordered_map<const Type*, uint32_t> positions;
+        auto addType = [this, &positions] (const Type* type) {
+            auto result = positions.emplace(type, static_cast<uint32_t>(positions.size()));
+            if (result.second)
+                m_types.push_back(type);
+            return result.first->second;
+        };
+        m_types.reserve(namedTypes.size() + typesByIndex.size());
+
+        std::vector<uint64_t> hashes;
+        for (const auto& namedType : namedTypes)
+            hashes.push_back(namedType.first.hash());
+        m_typesHash = PerfectHash(hashes);
+        m_typeNames.resize(namedTypes.size());
+        m_typePositions.resize(namedTypes.size());
+        for (const auto& namedType : namedTypes) {
+            auto slot = m_typesHash.slot(namedType.first.hash());
+            m_typeNames[slot] = namedType.first;
+            m_typePositions[slot] = addType(namedType.second);
+        }
+
+        m_typePositionsByIndex.resize(typesByIndex.size(), 0);
+        for (size_t i = 0; i < typesByIndex.size(); ++i) {
+            if (typesByIndex[i] != nullptr)
+                m_typePositionsByIndex[i] = addType(typesByIndex[i]) + 1;
+        }
+        m_types.shrink_to_fit();
+
+        hashes.clear();
+        for (const auto& namedFunction : namedFunctions)
+            hashes.push_back(namedFunction.first.hash());
+        m_functionsHash = PerfectHash(hashes);
+        std::vector<const std::pair<Symbol, const Function*>*> functionsBySlot(namedFunctions.size());
+        for (const auto& namedFunction : namedFunctions)
+            functionsBySlot[m_functionsHash.slot(namedFunction.first.hash())] = &namedFunction;
+        m_functionNames.reserve(namedFunctions.size());
+        m_functions.reserve(namedFunctions.size());
+        for (auto namedFunction : functionsBySlot) {
+            m_functionNames.push_back(namedFunction->first);
+            m_functions.push_back(*namedFunction->second);
+        }
+
+        addMembers();
+    }
+
+    void FrozenReflection::addMembers() {
+        std::vector<uint64_t> methodHashes;
+        std::vector<uint64_t> fieldHashes;
+        for (auto type : m_types) {
+            auto typeIndex = type->typeId().typeIndex();
+            for (const auto& function : type->functionMap())
+                methodHashes.push_back(memberHash(typeIndex, function.first));
+            for (const auto& field : type->m_fieldsIndex)
+                fieldHashes.push_back(memberHash(typeIndex, field.first));
+        }
+
+        m_methodsHash = PerfectHash(methodHashes);
+        m_methodKeys.resize(methodHashes.size());
+        m_methods.resize(methodHashes.size());
+        m_fieldsHash = PerfectHash(fieldHashes);
+        m_fieldKeys.resize(fieldHashes.size());
+        std::vector<const Field*> fieldsBySlot(fieldHashes.size());
+        for (auto type : m_types) {
+            auto typeIndex = type->typeId().typeIndex();
+            for (const auto& function : type->functionMap()) {
+                auto slot = m_methodsHash.slot(memberHash(typeIndex, function.first));
+                const auto& overloads = function.second.overloads();
+                m_methodKeys[slot] = MemberKey {typeIndex, function.first};
+                m_methods[slot] = MethodOverloads {static_cast<uint32_t>(m_overloads.size()), static_cast<uint32_t>(overloads.size())};
+                m_overloads.insert(m_overloads.end(), overloads.begin(), overloads.end());
+            }
+            for (const auto& field : type->m_fieldsIndex) {
+                auto slot = m_fieldsHash.slot(memberHash(typeIndex, field.first));
+                m_fieldKeys[slot] = MemberKey {typeIndex, field.first};
+                fieldsBySlot[slot] = &type->m_fields[field.second];
+            }
+        }
+        m_fields.reserve(fieldsBySlot.size());
+        for (auto field : fieldsBySlot)
+            m_fields.push_back(*field);
+    }
+
+    const Type& FrozenReflection::getType(std::string_view name) const {
+        if (auto type = findType(name))
+            return *type;
+        throw MojitoException(concat("Type \"", name, "\" is not registered"));
+    }
+
+    const Type& FrozenReflection::getType(Symbol name) const {
+        if (auto type = findType(name))
+            return *type;
+        throw MojitoException(concat("Type \"", name, "\" is not registered"));
+    }
+
+    const Type& FrozenReflection::getType(TypeId typeId) const {
+        if (auto type = findType(typeId))
+            return *type;
+        throw MojitoException(concat("Type ", getTypeName(typeId), " is not registered"));
+    }
+
+    const Type* FrozenReflection::findType(Symbol name) const noexcept {
+        if (m_typeNames.empty())
+            return nullptr;
+        auto slot = m_typesHash.slot(name.hash());
+        return m_typeNames[slot] == name ? m_types[m_typePositions[slot]] : nullptr;
+    }
+
+    const Type* FrozenReflection::findType(TypeId typeId) const noexcept {
+        auto index = typeId.typeIndex();
+        if (index >= m_typePositionsByIndex.size() || m_typePositionsByIndex[index] == 0)
+            return nullptr;
+        auto type = m_types[m_typePositionsByIndex[index] - 1];
+        return type->typeId() == typeId ? type : nullptr;
+    }
+
+    const Function& FrozenReflection::getFunction(std::string_view name) const {
+        if (auto function = findFunction(name))
+            return *function;
+        throw MojitoException(concat("Function \"", name, "\" is not registered."));
+    }
+
+    const Function& FrozenReflection::getFunction(Symbol name) const {
+        if (auto function = findFunction(name))
+            return *function;
+        throw MojitoException(concat("Function \"", name, "\" is not registered."));
+    }
+
+    const Function* FrozenReflection::findFunction(Symbol name) const noexcept {
+        if (m_functionNames.empty())
+            return nullptr;
+        auto slot = m_functionsHash.slot(name.hash());
+        return m_functionNames[slot] == name ? &m_functions[slot] : nullptr;
+    }
+
+    FrozenMethod FrozenReflection::method(TypeId typeId, std::string_view name) const {
+        if (auto method = findMethod(typeId, name))
+            return method;
+        throw MojitoException(concat("Method ", name, " is not registered"));
+    }
+
+    FrozenMethod FrozenReflection::method(TypeId typeId, Symbol name) const {
+        if (auto method = findMethod(typeId, name))
+            return method;
+        throw MojitoException(concat("Method ", name, " is not registered"));
+    }
+
+    FrozenMethod FrozenReflection::findMethod(TypeId typeId, Symbol name) const noexcept {
+        if (m_methodKeys.empty())
+            return FrozenMethod();
+        MemberKey key {typeId.typeIndex(), name};
+        auto slot = m_methodsHash.slot(memberHash(key.typeIndex, name));
+        if (!(m_methodKeys[slot] == key))
+            return FrozenMethod();
+        return FrozenMethod(&m_overloads[m_methods[slot].first], m_methods[slot].count);
+    }
+
+    const Field& FrozenReflection::field(TypeId typeId, std::string_view name) const {
+        if (auto field = findField(typeId, name))
+            return *field;
+        throw MojitoException(concat("Field ", name, " is not registered"));
+    }
+
+    const Field& FrozenReflection::field(TypeId typeId, Symbol name) const {
+        if (auto field = findField(typeId, name))
+            return *field;
+        throw MojitoException(concat("Field ", name, " is not registered"));
+    }
+
+    const Field* FrozenReflection::findField(TypeId typeId, Symbol name) const noexcept {
+        if (m_fieldKeys.empty())
+            return nullptr;
+        MemberKey key {typeId.typeIndex(), name};
+        auto slot = m_fieldsHash.slot(memberHash(key.typeIndex, name));
+        return m_fieldKeys[slot] == key ? &m_fields[slot] : nullptr;
+    }
+
+} // mojito
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FrozenMethod.hpp"
+#include "PerfectHash.hpp"
+#include "Symbol.hpp"
+#include "Type.hpp"
+
+namespace mojito {
+
+class Reflection;
+
+// Snapshot of a reflection and its base reflections, created by Reflection::freeze(). Registered types don't change
+// after they are published, so the snapshot refers to them instead of copying. Functions, and methods and fields
+// of all types, are copied into contiguous arrays, names are looked up with a minimal perfect hash.
+// Lookups and overload resolution don't write anything, so the snapshot can be shared between threads without locks.
+// It isn't entirely read only though: calls convert arguments through the source reflection, which caches
+// converters in a concurrent map.
+class FrozenReflection {
+    friend class Reflection; // To construct
+public:
+    bool hasType(std::string_view name) const noexcept { return findType(name) != nullptr; }
+
+    bool hasType(Symbol name) const noexcept { return findType(name) != nullptr; }
+
+    bool hasType(TypeId typeId) const noexcept { return findType(typeId) != nullptr; }
+
+    const Type& getType(std::string_view name) const;
+
+    const Type& getType(Symbol name) const;
+
+    const Type& getType(TypeId typeId) const;
+
+    // Non-throwing lookup, returns nullptr if the type is not registered
+    const Type* findType(std::string_view name) const noexcept { return findType(Symbol::find(name)); }
+
+    const Type* findType(Symbol name) const noexcept;
+
+    const Type* findType(TypeId typeId) const noexcept;
+
+    bool hasFunction(std::string_view name) const noexcept { return findFunction(name) != nullptr; }
+
+    bool hasFunction(Symbol name) const noexcept { return findFunction(name) != nullptr; }
+
+    const Function& getFunction(std::string_view name) const;
+
+    const Function& getFunction(Symbol name) const;
+
+    const Function* findFunction(std::string_view name) const noexcept { return findFunction(Symbol::find(name)); }
+
+    const Function* findFunction(Symbol name) const noexcept;
+
+    // Methods and fields of a registered type, keyed by the type id without qualifiers
+    FrozenMethod method(TypeId typeId, std::string_view name) const;
+
+    FrozenMethod method(TypeId typeId, Symbol name) const;
+
+    // Returns an empty method if there is no such method
+    FrozenMethod findMethod(TypeId typeId, std::string_view name) const noexcept { return findMethod(typeId, Symbol::find(name)); }
+
+    FrozenMethod findMethod(TypeId typeId, Symbol name) const noexcept;
+
+    const Field& field(TypeId typeId, std::string_view name) const;
+
+    const Field& field(TypeId typeId, Symbol name) const;
+
+    const Field* findField(TypeId typeId, std::string_view name) const noexcept { return findField(typeId, Symbol::find(name)); }
+
+    const Field* findField(TypeId typeId, Symbol name) const noexcept;
+
+    const std::vector<const Type*>& types() const noexcept { return m_types; }
+
+    const std::vector<Function>& functions() const noexcept { return m_functions; }
+
+private:
+    // Keeps reflections alive, as functions convert arguments with them
+    std::shared_ptr<const Reflection> m_reflection;
+    std::vector<const Type*> m_types;
+    // Names and positions of types in m_types, by slot of the perfect hash
+    PerfectHash m_typesHash;
+    std::vector<Symbol> m_typeNames;
+    std::vector<uint32_t> m_typePositions;
+    // Positions of types by dense type index, plus one. Zero for missing types.
+    std::vector<uint32_t> m_typePositionsByIndex;
+    // Functions and their names, by slot of the perfect hash
+    PerfectHash m_functionsHash;
+    std::vector<Symbol> m_functionNames;
+    std::vector<Function> m_functions;
+    // Members of all types, by slot of the perfect hash over the type index and the member name
+    struct MemberKey {
+        uint32_t typeIndex;
+        Symbol name;
+
+        bool operator==(const MemberKey& other) const noexcept { return typeIndex == other.typeIndex && name == other.name; }
+    };
+    struct MethodOverloads {
+        uint32_t first;
+        uint32_t count;
+    };
+    PerfectHash m_methodsHash;
+    std::vector<MemberKey> m_methodKeys;
+    std::vector<MethodOverloads> m_methods;
+    // Overloads of each method are stored next to each other
+    std::vector<Function> m_overloads;
+    PerfectHash m_fieldsHash;
+    std::vector<MemberKey> m_fieldKeys;
+    std::vector<Field> m_fields;
+
+    static uint64_t memberHash(uint32_t typeIndex, Symbol name) noexcept {
+        return PerfectHash::mix(name.hash() ^ typeIndex * 0x9e3779b97f4a7c15ull);
+    }
+
+    explicit FrozenReflection(std::shared_ptr<const Reflection> reflection);
+
+    void addMembers();
+};
+
+} // mojito
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <tuple>
-#include <functional>
+#include <vector>
 
 #include "Value.hpp"
 #include "AnyArg.hpp"
+#include "ArgFrame.hpp"
+#include "BoundFunction.hpp"
+#include "Expected.hpp"
 
 namespace mojito {
 
@@ -12,56 +15,78 @@ class Reflection;
 
 class Function {
 public:
+    // How the result is returned. Results of reference returning functions are non-owning values referring
+    // to the returned object, so they are not copied.
+    enum class ResultKind {
+        Void,
+        Value,
+        Reference,
+        Pointer
+    };
+
+    // Tag to distinguish inline member functions from non-member functions taking an object reference
+    struct InlineMember {};
+
+    // Signature of a member function, for lambdas it can't be deduced from
+    template <typename TypeT, typename ResultT, typename ... ArgT>
+    struct MemberSignature {};
+
     // FIXME: Make constructors private
     // Constructor for non-member functions
-    template <typename ResultT, typename ... ArgT, typename Indices = std::make_index_sequence<sizeof...(ArgT)>>
+    template <typename ResultT, typename ... ArgT>
     Function(const Reflection& reflection, ResultT (* func) (ArgT ...))
-        : m_function([func, &reflection] (const std::vector<AnyArg>& anyArgs) -> Value {
-            using ArgsTuple = std::tuple<ArgT...>;
-            if constexpr (std::is_same<ResultT, void>::value)
-                return call<ArgsTuple>(reflection, func, anyArgs, Indices{}), Value::makeVoid();
-            else
-                return call<ArgsTuple>(reflection, func, anyArgs, Indices{});
-        })
-        , m_argumentTypeIds {getTypeId<ArgT>()...}
+        : m_invoker(&invokeFunction<ResultT, ArgT...>)
+        , m_reflection(&reflection)
+        , m_argumentTypeIds(TypeIdList::of<ArgT...>())
         , m_resultTypeId (getTypeId<ResultT>())
-    {}
+        , m_resultKind (resultKindOf<ResultT>())
+        , m_signatureSerial (getTypeSerial<ResultT(ArgT...)>())
+        , m_typedThunk (reinterpret_cast<ErasedThunk>(&functionThunk<ResultT, ArgT...>))
+    {
+        m_callable.function = reinterpret_cast<void (*) ()>(func);
+    }
 
-    // Constructor for purely inline member functions (usually a lambda taking object refference as an argument)
+    // Constructor for purely inline member functions (usually a captureless lambda taking object refference as an argument)
     // Typically inline member function in standard library don't have an address at all, that's why this hack is needed.
-    template <typename TypeT, typename ResultT, typename ... ArgT, typename Indices = std::make_index_sequence<sizeof...(ArgT)>>
-    Function(const Reflection& reflection, const std::function<ResultT(TypeT&, ArgT ...)>& func)
-        : m_function([func, &reflection] (const std::vector<AnyArg>& anyArgs) -> Value {
-            using ArgsTuple = std::tuple<ArgT...>;
-            if constexpr (std::is_same<ResultT, void>::value)
-                return callInlineMember<TypeT, ArgsTuple>(reflection, func, anyArgs, Indices{}), Value::makeVoid();
-            else
-                return callInlineMember<TypeT, ArgsTuple>(reflection, func, anyArgs, Indices{});
-        })
-        , m_argumentTypeIds {getTypeId<ArgT>()...}
+    template <typename TypeT, typename ResultT, typename ... ArgT>
+    Function(const Reflection& reflection, InlineMember, ResultT (* func) (TypeT&, ArgT ...))
+        : m_invoker(&invokeInlineMember<TypeT, ResultT, ArgT...>)
+        , m_reflection(&reflection)
+        , m_argumentTypeIds(TypeIdList::of<ArgT...>())
         , m_classTypeId (getTypeId<TypeT>())
         , m_resultTypeId (getTypeId<ResultT>())
+        , m_resultKind (resultKindOf<ResultT>())
+        , m_signatureSerial (getTypeSerial<ResultT(TypeT&, ArgT...)>())
+        , m_typedThunk (reinterpret_cast<ErasedThunk>(&functionThunk<ResultT, TypeT&, ArgT...>))
+    {
+        m_callable.function = reinterpret_cast<void (*) ()>(func);
+    }
+
+    // Constructor for inline member functions with captures. Captures are kept in place of the function pointer, so
+    // they have to be trivially copyable and fit in the size of a member function pointer (e.g. two pointers).
+    template <typename LambdaT, typename TypeT, typename ResultT, typename ... ArgT>
+    Function(const Reflection& reflection, InlineMember, const LambdaT& lambda, MemberSignature<TypeT, ResultT, ArgT...>)
+        : m_invoker(&invokeInlineLambda<LambdaT, TypeT, ResultT, ArgT...>)
+        , m_reflection(&reflection)
+        , m_argumentTypeIds(TypeIdList::of<ArgT...>())
+        , m_classTypeId (getTypeId<TypeT>())
+        , m_resultTypeId (getTypeId<ResultT>())
+        , m_resultKind (resultKindOf<ResultT>())
+        , m_signatureSerial (getTypeSerial<ResultT(TypeT&, ArgT...)>())
+        , m_typedThunk (reinterpret_cast<ErasedThunk>(&lambdaThunk<LambdaT, ResultT, TypeT&, ArgT...>))
+        , m_callable (Callable::fromLambda(lambda))
     {}
 
     // Constructor for member functions
-    template <typename TypeT, typename ResultT, typename ... ArgT, typename Indices = std::make_index_sequence<sizeof...(ArgT)>>
+    template <typename TypeT, typename ResultT, typename ... ArgT>
     Function(const Reflection& reflection, ResultT (TypeT::*func) (ArgT ...))
-        : m_function([func, &reflection] (const std::vector<AnyArg>& anyArgs) -> Value {
-            using ArgsTuple = std::tuple<ArgT...>;
-            if constexpr (std::is_same<ResultT, void>::value)
-                return callMember<TypeT, ArgsTuple>(reflection, func, anyArgs, Indices{}), Value::makeVoid();
-            else
-                return callMember<TypeT, ArgsTuple>(reflection, func, anyArgs, Indices{});
-        })
-        , m_argumentTypeIds {getTypeId<ArgT>()...}
-        , m_classTypeId (getTypeId<TypeT>())
-        , m_resultTypeId (getTypeId<ResultT>())
+        : Function(reflection, func, MemberSignature<TypeT, ResultT, ArgT...>())
     {}
 
     // Constructor for const member functions
     template <typename TypeT, typename ResultT, typename ... ArgT>
     Function(const Reflection& reflection, ResultT (TypeT::*func) (ArgT ...) const)
-        : Function(reflection, reinterpret_cast<ResultT (TypeT::*) (ArgT ...)>(func))
+        : Function(reflection, func, MemberSignature<TypeT, ResultT, ArgT...>())
     {}
 
     template <typename ... ArgT>
@@ -69,49 +94,257 @@ public:
         auto totalArgsNum = m_argumentTypeIds.size() + (m_classTypeId.isValid() ? 1 : 0);
         if (sizeof...(ArgT) != totalArgsNum)
             throw MojitoException(concat("Wrong number of arguments. Expected: ", totalArgsNum, " Received: ", sizeof...(ArgT)));
-        return m_function(std::vector<AnyArg>{ AnyArg(std::forward<ArgT>(anyArgs)) ...});
+        const std::array<AnyArg, sizeof...(ArgT)> argFrame { AnyArg(std::forward<ArgT>(anyArgs)) ...};
+        return m_invoker(*this, argFrame);
     }
 
+    // Non-throwing call. Arguments are checked before the call, so wrong number of arguments or missing conversion
+    // are returned as error. Exceptions thrown by the function itself are not caught.
+    template <typename ... ArgT>
+    Expected<Value> tryInvoke(ArgT&& ... anyArgs) const {
+        auto totalArgsNum = m_argumentTypeIds.size() + (m_classTypeId.isValid() ? 1 : 0);
+        if (sizeof...(ArgT) != totalArgsNum)
+            return Error::wrongArgumentsNumber(totalArgsNum, sizeof...(ArgT));
+        const std::array<AnyArg, sizeof...(ArgT)> argFrame { AnyArg(std::forward<ArgT>(anyArgs)) ...};
+        for (size_t i = 0; i < argFrame.size(); ++i) {
+            auto sourceTypeId = argFrame[i].valueRef().typeId();
+            auto targetTypeId = parameterTypeId(i).decayed();
+            if (!sourceTypeId.canPassTo(targetTypeId) && !canConvert(*m_reflection, sourceTypeId, targetTypeId))
+                return Error::noConversion(sourceTypeId, targetTypeId);
+        }
+        return m_invoker(*this, argFrame);
+    }
+
+    // Returns typed handle to call the function directly. Signature should match the registered one exactly,
+    // with the object reference as the first argument for member functions. E.g. bind<int(TestClass&, int)>().
+    template <typename SignatureT>
+    BoundFunction<SignatureT> bind() const {
+        using BoundFunctionT = BoundFunction<SignatureT>;
+        std::vector<TypeId> argumentTypeIds(m_argumentTypeIds.begin(), m_argumentTypeIds.end());
+        if (m_classTypeId.isValid())
+            argumentTypeIds.insert(argumentTypeIds.begin(), m_classTypeId);
+        if (BoundFunctionT::resultTypeId() != m_resultTypeId || BoundFunctionT::argumentTypeIds() != argumentTypeIds)
+            throw MojitoException("Signature doesn't match to the function");
+        if (getTypeSerial<SignatureT>() != m_signatureSerial)
+            throw MojitoException("Signature matches to the function only up to qualifiers. Exact match is required.");
+        return BoundFunctionT(reinterpret_cast<typename BoundFunctionT::Thunk>(m_typedThunk), m_callable);
+    }
+
+    template <typename SignatureT>
+    bool hasSignature() const { return getTypeSerial<SignatureT>() == m_signatureSerial; }
+
+    // Checks type ids of call arguments, including the object for member functions
+    template <typename TypeIdsT>
+    bool matchesExactly(const TypeIdsT& typeIds) const {
+        return matchesTypeIds(typeIds, [](TypeId typeId, TypeId targetTypeId) { return typeId.canBindTo(targetTypeId); });
+    }
+
+    // Cost of passing arguments with the type ids: zero if all of them bind exactly, one more for each argument
+    // passed as a copy without qualifiers and two more for each converted one. NotViable if some can't be passed.
+    template <typename TypeIdsT>
+    size_t conversionCost(const TypeIdsT& typeIds) const {
+        size_t objectArgsNum = m_classTypeId.isValid() ? 1 : 0;
+        if (typeIds.size() != m_argumentTypeIds.size() + objectArgsNum)
+            return NotViable;
+        size_t cost = 0;
+        for (size_t i = 0; i < typeIds.size(); ++i) {
+            auto parameter = parameterTypeId(i);
+            if (typeIds[i].canBindTo(parameter))
+                continue;
+            if (typeIds[i].canPassTo(parameter.decayed()))
+                cost += 1;
+            // The object is never converted
+            else if (i >= objectArgsNum && canConvert(*m_reflection, typeIds[i], parameter.decayed()))
+                cost += 2;
+            else
+                return NotViable;
+        }
+        return cost;
+    }
+
+    static constexpr size_t NotViable = ~size_t(0);
+
     template <typename ... ArgT>
     bool fitArgs(const ArgT& ... args) const {
         return sizeof...(ArgT) == m_argumentTypeIds.size() && fitArgsInternal(0, args ...);
     }
 
-    const std::vector<TypeId>& argumentTypeIds() const { return m_argumentTypeIds; }
+    TypeIdList argumentTypeIds() const { return m_argumentTypeIds; }
     TypeId resultTypeId() const { return m_resultTypeId; }
+    ResultKind resultKind() const { return m_resultKind; }
 
 private:
-    std::function<Value(const std::vector<AnyArg>& anyArgs)> m_function;
-    std::vector<TypeId> m_argumentTypeIds;
+    // Const and non-const member functions keep their own pointer types, so nothing is cast between them
+    template <typename MemberFunctionT, typename TypeT, typename ResultT, typename ... ArgT>
+    Function(const Reflection& reflection, MemberFunctionT func, MemberSignature<TypeT, ResultT, ArgT...>)
+        : m_invoker(&invokeMember<MemberFunctionT, TypeT, ResultT, ArgT...>)
+        , m_reflection(&reflection)
+        , m_argumentTypeIds(TypeIdList::of<ArgT...>())
+        , m_classTypeId (getTypeId<TypeT>())
+        , m_resultTypeId (getTypeId<ResultT>())
+        , m_resultKind (resultKindOf<ResultT>())
+        , m_signatureSerial (getTypeSerial<ResultT(TypeT&, ArgT...)>())
+        , m_typedThunk (reinterpret_cast<ErasedThunk>(&memberThunk<MemberFunctionT, TypeT, ResultT, ArgT...>))
+        , m_callable (Callable::fromMemberFunction(func))
+    {}
+
+    // Invoker is a plain function pointer instantiated for the exact signature. It restores the function pointer
+    // from m_callable, so a reflective call costs a single indirect call besides the call of the function itself.
+    using Invoker = Value (*) (const Function& function, const ArgFrame& args);
+    Invoker m_invoker;
+    const Reflection* m_reflection;
+    TypeIdList m_argumentTypeIds;
     TypeId m_classTypeId; // only for member functions
     TypeId m_resultTypeId;
+    ResultKind m_resultKind;
+    // Fields used by bind(). Typed thunk is erased to a plain function pointer and restored by the signature.
+    using ErasedThunk = void (*) ();
+    intptr_t m_signatureSerial;
+    ErasedThunk m_typedThunk;
+    // Function pointer shared by the invoker and the typed thunk
+    Callable m_callable {};
+
+    template <typename ResultT, typename ... ArgT>
+    static ResultT functionThunk(const Callable& callable, ArgT ... args) {
+        return reinterpret_cast<ResultT (*) (ArgT ...)>(callable.function)(std::forward<ArgT>(args)...);
+    }
+
+    template <typename LambdaT, typename ResultT, typename ... ArgT>
+    static ResultT lambdaThunk(const Callable& callable, ArgT ... args) {
+        return callable.toLambda<LambdaT>()(std::forward<ArgT>(args)...);
+    }
+
+    template <typename MemberFunctionT, typename TypeT, typename ResultT, typename ... ArgT>
+    static ResultT memberThunk(const Callable& callable, TypeT& object, ArgT ... args) {
+        return (object.*callable.toMemberFunction<MemberFunctionT>())(std::forward<ArgT>(args)...);
+    }
+
+    template <typename ResultT, typename ... ArgT>
+    static Value invokeFunction(const Function& function, const ArgFrame& args) {
+        using ArgsTuple = std::tuple<ArgT...>;
+        using Indices = std::make_index_sequence<sizeof...(ArgT)>;
+        auto func = reinterpret_cast<ResultT (*) (ArgT ...)>(function.m_callable.function);
+        return makeResult<ResultT, ArgsTuple>(args, [&] () -> decltype(auto) {
+            return call<ArgsTuple>(*function.m_reflection, func, args, Indices{});
+        });
+    }
+
+    template <typename TypeT, typename ResultT, typename ... ArgT>
+    static Value invokeInlineMember(const Function& function, const ArgFrame& args) {
+        using ArgsTuple = std::tuple<ArgT...>;
+        using Indices = std::make_index_sequence<sizeof...(ArgT)>;
+        auto func = reinterpret_cast<ResultT (*) (TypeT&, ArgT ...)>(function.m_callable.function);
+        return makeResult<ResultT, std::tuple<TypeT&, ArgT...>>(args, [&] () -> decltype(auto) {
+            return callInlineMember<TypeT, ArgsTuple>(*function.m_reflection, func, args, Indices{});
+        });
+    }
+
+    template <typename LambdaT, typename TypeT, typename ResultT, typename ... ArgT>
+    static Value invokeInlineLambda(const Function& function, const ArgFrame& args) {
+        using ArgsTuple = std::tuple<ArgT...>;
+        using Indices = std::make_index_sequence<sizeof...(ArgT)>;
+        const auto& lambda = function.m_callable.toLambda<LambdaT>();
+        return makeResult<ResultT, std::tuple<TypeT&, ArgT...>>(args, [&] () -> decltype(auto) {
+            return callInlineMember<TypeT, ArgsTuple>(*function.m_reflection, lambda, args, Indices{});
+        });
+    }
+
+    template <typename MemberFunctionT, typename TypeT, typename ResultT, typename ... ArgT>
+    static Value invokeMember(const Function& function, const ArgFrame& args) {
+        using ArgsTuple = std::tuple<ArgT...>;
+        using Indices = std::make_index_sequence<sizeof...(ArgT)>;
+        auto func = function.m_callable.toMemberFunction<MemberFunctionT>();
+        return makeResult<ResultT, std::tuple<TypeT&, ArgT...>>(args, [&] () -> decltype(auto) {
+            return callMember<TypeT, ArgsTuple>(*function.m_reflection, func, args, Indices{});
+        });
+    }
+
+    // Type id of the parameter by index, including the object for member functions
+    TypeId parameterTypeId(size_t index) const {
+        if (!m_classTypeId.isValid())
+            return m_argumentTypeIds[index];
+        return index == 0 ? m_classTypeId : m_argumentTypeIds[index - 1];
+    }
+
+    // Reflection is passed as template argument to defer instantiation until Reflection is complete
+    template <typename ReflectionT>
+    static bool canConvert(const ReflectionT& reflection, TypeId sourceTypeId, TypeId targetTypeId) {
+        return reflection.canConvert(sourceTypeId, targetTypeId);
+    }
+
+    // Reference results are returned without copying, unless they may refer to an argument that is destroyed with
+    // the call. Parameters are the ones of the function, including the object for member functions.
+    template <typename ResultT, typename ParametersTupleT, typename CallT>
+    static Value makeResult(const ArgFrame& args, CallT&& call) {
+        if constexpr (std::is_same<ResultT, void>::value) {
+            return call(), Value::makeVoid();
+        } else if constexpr (std::is_lvalue_reference<ResultT>::value) {
+            ResultT result = call();
+            // Arguments are converted during the call, so they are checked after it
+            if (!passesTemporaries<ParametersTupleT>(args, std::make_index_sequence<std::tuple_size_v<ParametersTupleT>>()))
+                return Value::makeReference(result);
+            if constexpr (std::is_copy_constructible_v<std::decay_t<ResultT>>)
+                return Value(result);
+            else
+                throw MojitoException("Result refers to a temporary argument and can't be copied");
+        } else {
+            return call();
+        }
+    }
+
+    // Only arguments bound to reference parameters can be referred to by the result
+    template <typename ParametersTupleT, size_t ... I>
+    static bool passesTemporaries(const ArgFrame& args, std::index_sequence<I...>) {
+        return ((std::is_reference_v<std::tuple_element_t<I, ParametersTupleT>> && args[I].isTemporary()) || ...);
+    }
+
+    template <typename ResultT>
+    static constexpr ResultKind resultKindOf() {
+        if constexpr (std::is_same<ResultT, void>::value)
+            return ResultKind::Void;
+        else if constexpr (std::is_lvalue_reference<ResultT>::value)
+            return ResultKind::Reference;
+        else if constexpr (std::is_pointer<ResultT>::value)
+            return ResultKind::Pointer;
+        else
+            return ResultKind::Value;
+    }
 
     template<typename ArgsTupleT, typename FuncT,  std::size_t... I>
-    static auto call(const Reflection& reflection, FuncT&& func, const std::vector<AnyArg>& args, std::index_sequence<I...>) {
+    static decltype(auto) call(const Reflection& reflection, FuncT&& func, const ArgFrame& args, std::index_sequence<I...>) {
         return func(args[I].as<typename std::tuple_element<I, ArgsTupleT>::type>(reflection)...);
     }
 
     template<typename TypeT, typename ArgsTupleT, typename FuncT,  std::size_t... I>
-    static auto callMember(const Reflection& reflection, FuncT&& func, const std::vector<AnyArg>& args, std::index_sequence<I...>) {
+    static decltype(auto) callMember(const Reflection& reflection, FuncT&& func, const ArgFrame& args, std::index_sequence<I...>) {
         return (args.front().as<TypeT&>(reflection).*func)(args[I + 1].as<typename std::tuple_element<I, ArgsTupleT>::type>(reflection)...);
     }
 
     template<typename TypeT, typename ArgsTupleT, typename FuncT,  std::size_t... I>
-    static auto callInlineMember(const Reflection& reflection, FuncT&& func, const std::vector<AnyArg>& args, std::index_sequence<I...>) {
+    static decltype(auto) callInlineMember(const Reflection& reflection, FuncT&& func, const ArgFrame& args, std::index_sequence<I...>) {
         return func(args.front().as<TypeT&>(reflection), args[I + 1].as<typename std::tuple_element<I, ArgsTupleT>::type>(reflection)...);
     }
 
+    template <typename TypeIdsT, typename MatchT>
+    bool matchesTypeIds(const TypeIdsT& typeIds, MatchT match) const {
+        size_t objectArgsNum = m_classTypeId.isValid() ? 1 : 0;
+        if (typeIds.size() != m_argumentTypeIds.size() + objectArgsNum)
+            return false;
+        if (objectArgsNum == 1 && !match(typeIds[0], m_classTypeId))
+            return false;
+        for (size_t i = 0; i < m_argumentTypeIds.size(); ++i) {
+            if (!match(typeIds[i + objectArgsNum], m_argumentTypeIds[i]))
+                return false;
+        }
+        return true;
+    }
+
     template <typename...>
     bool fitArgsInternal(size_t) const { return true; }
 
     template <typename FrontArgT, typename ... ArgT>
     bool fitArgsInternal(size_t index, const FrontArgT& frontArg, const ArgT& ... args) const {
-        if constexpr (std::is_same_v<std::decay_t<FrontArgT>, AnyArg>)
-            return frontArg.valueRef().typeId().canAssignTo(m_argumentTypeIds[index]) && fitArgsInternal<ArgT...>(index + 1, args...);
-        else if constexpr (std::is_convertible_v<std::decay_t<FrontArgT>&, ValueRef&>)
-            return frontArg.typeId().canAssignTo(m_argumentTypeIds[index]) && fitArgsInternal<ArgT...>(index + 1, args...);
-        else
-            return getTypeId<FrontArgT>().canAssignTo(m_argumentTypeIds[index]) && fitArgsInternal<ArgT...>(index + 1, args...);
+        return argumentTypeId(frontArg).canAssignTo(m_argumentTypeIds[index]) && fitArgsInternal<ArgT...>(index + 1, args...);
     }
 };
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "OverloadSet.hpp"
+
+namespace mojito {
+
+// Method of a type resolved once by name with Type::methodHandle(). Calls go straight to the overload set,
+// so the name isn't hashed again. Valid as long as the type it was resolved from.
+class MethodHandle {
+    friend class Type; // To construct
+public:
+    MethodHandle() = default;
+
+    explicit operator bool() const noexcept { return m_overloadSet != nullptr; }
+
+    const OverloadSet& overloads() const { return *m_overloadSet; }
+
+    template <typename ... ArgT>
+    Value operator()(ArgT&& ... anyArgs) const {
+        return (*m_overloadSet)(std::forward<ArgT>(anyArgs)...);
+    }
+
+    template <typename ... ArgT>
+    Expected<Value> tryInvoke(ArgT&& ... anyArgs) const {
+        return m_overloadSet->tryInvoke(std::forward<ArgT>(anyArgs)...);
+    }
+
+    bool operator==(const MethodHandle& other) const noexcept { return m_overloadSet == other.m_overloadSet; }
+
+    bool operator!=(const MethodHandle& other) const noexcept { return m_overloadSet != other.m_overloadSet; }
+
+private:
+    const OverloadSet* m_overloadSet = nullptr;
+
+    explicit MethodHandle(const OverloadSet* overloadSet) noexcept
+        : m_overloadSet(overloadSet)
+    {}
+};
+
+} // mojito
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "PerfectHash.hpp"
+#include "TypeId.hpp"
+
+namespace mojito {
+
+// Constant table of names with a minimal perfect hash over them, emitted by the generator for the whole binary.
+// A lookup hashes the name once and compares it with the single candidate, nothing is built at startup.
+// Tables are hashed with typeNameHash, displacements are the ones of PerfectHash.
+struct NameTable {
+    static constexpr size_t NotFound = ~size_t(0);
+
+    const uint32_t* displacements = nullptr;
+    size_t bucketsCount = 0;
+    const std::string_view* names = nullptr;
+    size_t size = 0;
+
+    // Index of the name in the table or NotFound
+    constexpr size_t find(std::string_view name) const noexcept {
+        if (size == 0)
+            return NotFound;
+        auto hash = typeNameHash(name);
+        auto slot = PerfectHash::slot(hash, displacements[PerfectHash::bucketIndex(hash, bucketsCount)], size);
+        return names[slot] == name ? slot : NotFound;
+    }
+
+    // Tables with the same names in the same slots, e.g. emitted again by generated registration running twice
+    bool operator==(const NameTable& other) const noexcept {
+        return size == other.size && bucketsCount == other.bucketsCount
+            && std::equal(names, names + size, other.names)
+            && std::equal(displacements, displacements + bucketsCount, other.displacements);
+    }
+
+    bool operator!=(const NameTable& other) const noexcept { return !operator==(other); }
+};
+
+} // mojito
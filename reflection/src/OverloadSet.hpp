@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "Function.hpp"
+
+namespace mojito {
+
+// Returns index of the overload taking the arguments with the lowest conversion cost, the first one on a tie.
+// Returns number of overloads if nothing matches.
+template <typename TypeIdsT>
+size_t findOverload(const Function* overloads, size_t overloadsCount, const TypeIdsT& argumentTypeIds) {
+    auto bestIndex = overloadsCount;
+    auto bestCost = Function::NotViable;
+    for (size_t i = 0; i < overloadsCount && bestCost != 0; ++i) {
+        auto cost = overloads[i].conversionCost(argumentTypeIds);
+        if (cost < bestCost) {
+            bestIndex = i;
+            bestCost = cost;
+        }
+    }
+    return bestIndex;
+}
+
+// Functions registered under the same name. A call is dispatched by type ids of passed arguments to the overload
+// taking them with the fewest copies and conversions (see Function::conversionCost()), the first registered on a tie.
+// Last resolved signature is cached, so repeated calls with the same argument types skip the resolution.
+class OverloadSet {
+public:
+    OverloadSet() = default;
+
+    OverloadSet(const OverloadSet& other)
+        : m_functions(other.m_functions)
+        , m_lastResolved(other.m_lastResolved.load(std::memory_order_relaxed))
+    {}
+
+    OverloadSet& operator=(const OverloadSet& other) {
+        m_functions = other.m_functions;
+        m_lastResolved.store(other.m_lastResolved.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void add(const Function& function) {
+        if (m_functions.size() > IndexMask)
+            throw MojitoException(concat("Too many overloads. Max: ", IndexMask + 1));
+        m_functions.push_back(function);
+    }
+
+    template <typename ... ArgT>
+    Value operator()(ArgT&& ... anyArgs) const {
+        if (m_functions.size() == 1)
+            return m_functions.front()(std::forward<ArgT>(anyArgs)...);
+        const std::array<TypeId, sizeof...(ArgT)> argumentTypeIds {argumentTypeId(anyArgs)...};
+        return resolve(argumentTypeIds)(std::forward<ArgT>(anyArgs)...);
+    }
+
+    // Non-throwing call, see Function::tryInvoke()
+    template <typename ... ArgT>
+    Expected<Value> tryInvoke(ArgT&& ... anyArgs) const {
+        if (m_functions.size() == 1)
+            return m_functions.front().tryInvoke(std::forward<ArgT>(anyArgs)...);
+        const std::array<TypeId, sizeof...(ArgT)> argumentTypeIds {argumentTypeId(anyArgs)...};
+        auto function = tryResolve(argumentTypeIds);
+        if (function == nullptr)
+            return Error(ErrorCode::NoOverload);
+        return function->tryInvoke(std::forward<ArgT>(anyArgs)...);
+    }
+
+    // Returns typed handle of the overload with exactly the same signature. See Function::bind().
+    template <typename SignatureT>
+    BoundFunction<SignatureT> bind() const {
+        for (const auto& function : m_functions) {
+            if (function.hasSignature<SignatureT>())
+                return function.bind<SignatureT>();
+        }
+        throw MojitoException("No overload with the signature");
+    }
+
+    const std::vector<Function>& overloads() const { return m_functions; }
+
+    // Bytes of the overloads storage
+    size_t memoryBytes() const noexcept { return m_functions.capacity() * sizeof(Function); }
+
+    size_t size() const { return m_functions.size(); }
+
+    const Function& front() const { return m_functions.front(); }
+
+private:
+    // Signature hash and index of the overload packed together, so the cache is updated atomically
+    static constexpr size_t IndexMask = 0xff;
+
+    std::vector<Function> m_functions;
+    mutable std::atomic<size_t> m_lastResolved { 0 };
+
+    template <typename TypeIdsT>
+    const Function& resolve(const TypeIdsT& argumentTypeIds) const {
+        if (auto function = tryResolve(argumentTypeIds))
+            return *function;
+        throw MojitoException("No overload matches the arguments");
+    }
+
+    template <typename TypeIdsT>
+    const Function* tryResolve(const TypeIdsT& argumentTypeIds) const {
+        auto hash = signatureHash(argumentTypeIds) & ~IndexMask;
+        auto lastResolved = m_lastResolved.load(std::memory_order_relaxed);
+        if (lastResolved != 0 && (lastResolved & ~IndexMask) == hash) {
+            const auto& function = m_functions[lastResolved & IndexMask];
+            if (function.conversionCost(argumentTypeIds) != Function::NotViable)
+                return &function;
+        }
+        auto index = findOverload(m_functions.data(), m_functions.size(), argumentTypeIds);
+        if (index == m_functions.size())
+            return nullptr;
+        m_lastResolved.store(hash | index, std::memory_order_relaxed);
+        return &m_functions[index];
+    }
+};
+
+} // mojito
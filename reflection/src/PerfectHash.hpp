@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Utility.hpp"
+
+namespace mojito {
+
+// Minimal perfect hash over a fixed set of hashes (hash and displace). Every hash of the set gets its own
+// slot in range [0, size), so tables indexed by the slot have no empty entries and no probing.
+// Hashes outside of the set get some slot too, so a lookup should compare the key stored in the slot.
+class PerfectHash {
+public:
+    PerfectHash() = default;
+
+    // Throws if hashes are not unique
+    explicit PerfectHash(const std::vector<uint64_t>& hashes)
+        : m_size(hashes.size())
+        , m_displacements(std::max<size_t>(hashes.size(), 1), 0)
+    {
+        std::vector<std::vector<uint64_t>> buckets(m_displacements.size());
+        for (auto hash : hashes)
+            buckets[bucketIndex(hash, buckets.size())].push_back(hash);
+        std::vector<uint32_t> order(buckets.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        // Large buckets are placed first, while there are many free slots
+        std::stable_sort(order.begin(), order.end(), [&buckets] (uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+        std::vector<bool> taken(m_size, false);
+        std::vector<size_t> slots;
+        for (auto bucketIndex : order) {
+            const auto& bucket = buckets[bucketIndex];
+            if (bucket.empty())
+                break;
+            uint32_t displacement = 1;
+            while (!tryPlace(bucket, displacement, taken, slots)) {
+                if (++displacement == MaxDisplacement)
+                    throw MojitoException("Can't build perfect hash, hashes are not unique");
+            }
+            for (auto slot : slots)
+                taken[slot] = true;
+            m_displacements[bucketIndex] = displacement;
+        }
+    }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t slot(uint64_t hash) const noexcept {
+        return slot(hash, m_displacements[bucketIndex(hash, m_displacements.size())], m_size);
+    }
+
+    const std::vector<uint32_t>& displacements() const noexcept { return m_displacements; }
+
+    static constexpr uint64_t mix(uint64_t hash) noexcept {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    static constexpr size_t bucketIndex(uint64_t hash, size_t bucketsCount) noexcept {
+        return static_cast<size_t>(mix(hash) % bucketsCount);
+    }
+
+    static constexpr size_t slot(uint64_t hash, uint32_t displacement, size_t size) noexcept {
+        return size != 0 ? static_cast<size_t>(mix(hash + displacement * 0x9e3779b97f4a7c15ull) % size) : 0;
+    }
+
+private:
+    static constexpr uint32_t MaxDisplacement = 1 << 24;
+
+    size_t m_size = 0;
+    std::vector<uint32_t> m_displacements = std::vector<uint32_t>(1, 0);
+
+    bool tryPlace(const std::vector<uint64_t>& bucket, uint32_t displacement, const std::vector<bool>& taken, std::vector<size_t>& slots) const {
+        slots.clear();
+        for (auto hash : bucket) {
+            auto slot = PerfectHash::slot(hash, displacement, m_size);
+            if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end())
+                return false;
+            slots.push_back(slot);
+        }
+        return true;
+    }
+};
+
+} // mojito
@@ -1,45 +1,386 @@
 #include "Reflection.hpp"
 
+#include <algorithm>
+
+#include "FrozenReflection.hpp"
+
 namespace mojito {
 
-    bool Reflection::hasType(const std::string& name) const {
-        return m_typesMap.find(name) != m_typesMap.end();
+    Reflection::Reflection(const std::shared_ptr<Reflection>& baseReflection)
+        : m_baseReflection(baseReflection)
+    {
+        if (m_baseReflection == nullptr) {
+            rebuildLookupFilter(0);
+            return;
+        }
+        // Registrations in the base wait until the reflection is in the list, the filter already has names registered before
+        std::lock_guard<std::mutex> lock(m_baseReflection->m_chainMutex);
+        rebuildLookupFilter(0);
+        m_baseReflection->m_derivedReflections.push_back(this);
+    }
+
+    Reflection::~Reflection() {
+        if (m_baseReflection == nullptr)
+            return;
+        std::lock_guard<std::mutex> lock(m_baseReflection->m_chainMutex);
+        auto& derivedReflections = m_baseReflection->m_derivedReflections;
+        derivedReflections.erase(std::find(derivedReflections.begin(), derivedReflections.end(), this));
+    }
+
+    bool Reflection::hasType(std::string_view name) const {
+        return findType(name) != nullptr;
+    }
+
+    bool Reflection::hasType(Symbol name) const {
+        return findType(name) != nullptr;
     }
 
-    // FIXME: Check order
     bool Reflection::hasType(TypeId typeId) const {
-        if (m_baseReflection != nullptr)
-            return m_baseReflection->hasType(typeId);
-        return hasType(m_typeNameMap.at(typeId));
+        return findType(typeId) != nullptr;
     }
 
-    const Type& Reflection::getType(const std::string& name) const {
-        auto iter = m_typesMap.find(name);
-        if (iter != m_typesMap.end())
-            return *iter->second;
-        if (m_baseReflection != nullptr)
-            return m_baseReflection->getType(name);
+    const Type& Reflection::getType(std::string_view name) const {
+        if (auto type = findType(name))
+            return *type;
+        throw MojitoException(concat("Type \"", name, "\" is not registered"));
+    }
+
+    const Type& Reflection::getType(Symbol name) const {
+        if (auto type = findType(name))
+            return *type;
         throw MojitoException(concat("Type \"", name, "\" is not registered"));
     }
 
-    // FIXME: Check order
     const Type& Reflection::getType(TypeId typeId) const {
-        if (m_baseReflection != nullptr)
-            return m_baseReflection->getType(typeId);
-        return getType(m_typeNameMap.at(typeId));
+        if (auto type = findType(typeId))
+            return *type;
+        throw MojitoException(concat("Type ", getTypeName(typeId), " is not registered"));
+    }
+
+    Type* Reflection::findRegisteredType(std::string_view name, TypeId typeId) const {
+        auto type = m_typesMap.find(Symbol::find(name));
+        return type != nullptr && (*type)->typeId() == typeId ? *type : nullptr;
+    }
+
+    Type* Reflection::createType(TypeId typeId, const std::vector<TypeId>& parents) {
+#ifdef MOJITO_STABLE_TYPE_IDS
+        // Takes the process-wide lock, so it's done only when type ids are made stable
+        registerStableTypeId(typeId);
+#endif
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        return m_arena.create<Type>(typeId, parents, *this);
+    }
+
+    Type& Reflection::addType(std::string_view name, Type* newType) {
+        Symbol symbol(name);
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        // If the name is taken, the new type stays unused in the arena until destruction
+        auto result = m_typesMap.insert(symbol, newType);
+        auto& type = **result.first;
+        if (!result.second) {
+            if (type.typeId() != newType->typeId())
+                throw MojitoException(concat("Type \"", name, "\" is already registered"));
+            return type;
+        }
+        addToTypeIndex(type);
+        addToNameTable(name, type);
+        m_generation.fetch_add(1, std::memory_order_release);
+        auto hash = symbol.hash();
+        propagateRegistration(&hash, 1);
+        return type;
+    }
+
+    void Reflection::adoptTypeTable(const StaticTypeTable& typeTable) {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        std::vector<size_t> hashes;
+        hashes.reserve(typeTable.size);
+        for (size_t i = 0; i < typeTable.size; ++i) {
+            const auto& typeInfo = typeTable.types[i];
+            if (!m_lazyTypes.insert(typeInfo.name, &typeInfo).second)
+                continue;
+            auto typeId = typeInfo.typeId();
+#ifdef MOJITO_STABLE_TYPE_IDS
+            registerStableTypeId(typeId);
+#endif
+            auto index = assignTypeIndex(typeId);
+            if (m_lazyTypesByIndex.load(index) == nullptr)
+                m_lazyTypesByIndex.store(index, &typeInfo);
+            // Same hash as the symbol of the name will have
+            hashes.push_back(std::hash<std::string_view>()(typeInfo.name));
+        }
+        m_generation.fetch_add(1, std::memory_order_release);
+        propagateRegistration(hashes.data(), hashes.size());
+    }
+
+    const Type* Reflection::registerLazyType(const StaticTypeInfo& typeInfo) const {
+        std::lock_guard<std::mutex> lock(m_lazyRegistrationMutex);
+        if (auto registeredType = m_typesMap.find(Symbol::find(typeInfo.name)))
+            return *registeredType;
+        // Reflections are never created const, only accessed as const
+        auto reflection = const_cast<Reflection*>(this);
+        // Members are added before the type is published, so concurrent lookups never see a partially registered type
+        auto type = reflection->createType(typeInfo.typeId(), {});
+        typeInfo.addMembers(*type);
+        return &reflection->addType(typeInfo.name, type);
+    }
+
+    void Reflection::registerLazyTypes() const {
+        // Registered outside of forEach, as adoption takes the locks in the other order
+        std::vector<const StaticTypeInfo*> typeInfos;
+        m_lazyTypes.forEach([&typeInfos] (std::string_view, const StaticTypeInfo* typeInfo) {
+            typeInfos.push_back(typeInfo);
+        });
+        for (auto typeInfo : typeInfos)
+            registerLazyType(*typeInfo);
+    }
+
+    void Reflection::propagateRegistration(const size_t* hashes, size_t count) {
+        std::lock_guard<std::mutex> lock(m_chainMutex);
+        auto filter = m_lookupFilters.back().get();
+        if (m_lookupFilterEntries + count > filter->capacity()) {
+            // Registered names are in the maps already, so the new filter has them
+            rebuildLookupFilter(2 * (m_lookupFilterEntries + count));
+        } else {
+            for (size_t i = 0; i < count; ++i)
+                filter->add(hashes[i]);
+            m_lookupFilterEntries += count;
+        }
+        m_chainGeneration.fetch_add(1, std::memory_order_release);
+        for (auto derivedReflection : m_derivedReflections)
+            derivedReflection->propagateRegistration(hashes, count);
+    }
+
+    void Reflection::rebuildLookupFilter(size_t capacity) {
+        std::vector<size_t> hashes;
+        for (auto reflection = this; reflection != nullptr; reflection = reflection->m_baseReflection.get()) {
+            reflection->m_typesMap.forEach([&hashes] (Symbol name, const Type*) {
+                hashes.push_back(name.hash());
+            });
+            reflection->m_functionMap.forEach([&hashes] (Symbol name, const Function*) {
+                hashes.push_back(name.hash());
+            });
+            reflection->m_lazyTypes.forEach([&hashes] (std::string_view name, const StaticTypeInfo*) {
+                hashes.push_back(std::hash<std::string_view>()(name));
+            });
+        }
+        auto filter = std::make_unique<LookupFilter>(std::max(capacity, 2 * hashes.size()));
+        for (auto hash : hashes)
+            filter->add(hash);
+        m_lookupFilterEntries = hashes.size();
+        m_lookupFilters.push_back(std::move(filter));
+        m_lookupFilter.store(m_lookupFilters.back().get(), std::memory_order_release);
+    }
+
+    void Reflection::addToTypeIndex(const Type& type) {
+        auto index = assignTypeIndex(type.typeId());
+        // The first registration of the type id in the reflection wins
+        if (m_typesByIndex.load(index) == nullptr)
+            m_typesByIndex.store(index, &type);
+    }
+
+    void Reflection::addToNameTable(std::string_view name, const Type& type) {
+        auto nameTable = m_nameTable.load(std::memory_order_relaxed);
+        if (nameTable == nullptr)
+            return;
+        auto index = nameTable->find(name);
+        if (index != NameTable::NotFound)
+            m_typesByName.store(index, &type);
     }
 
-    bool Reflection::hasFunction(const std::string& name) const {
-        return m_functionMap.find(name) != m_functionMap.end();
+    void Reflection::setNameTable(const NameTable& nameTable) {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        if (auto currentTable = m_nameTable.load(std::memory_order_relaxed)) {
+            // Setting the same table again keeps the current one, a table can't be replaced by a different one
+            if (*currentTable == nameTable)
+                return;
+            throw MojitoException("A different name table is already set");
+        }
+        for (size_t i = 0; i < nameTable.size; ++i) {
+            if (auto type = m_typesMap.find(Symbol::find(nameTable.names[i])))
+                m_typesByName.store(i, *type);
+        }
+        m_nameTable.store(&nameTable, std::memory_order_release);
     }
 
-    const Function& Reflection::getFunction(const std::string& name) const {
-        auto iter = m_functionMap.find(name);
-        if (iter != m_functionMap.end())
-            return *iter->second;
-        if (m_baseReflection != nullptr)
-            return m_baseReflection->getFunction(name);
+    uint32_t Reflection::assignTypeIndex(TypeId typeId) {
+        static std::atomic<uint32_t> lastTypeIndex {0};
+        auto& slotIndex = typeId.slot()->index;
+        auto index = slotIndex.load(std::memory_order_acquire);
+        if (index != 0)
+            return index;
+        // If another thread wins the race, the new index is just skipped
+        auto newIndex = lastTypeIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (slotIndex.compare_exchange_strong(index, newIndex, std::memory_order_acq_rel))
+            return newIndex;
+        return index;
+    }
+
+    template <typename KeyT, typename ValueT, typename FindLocalT>
+    const ValueT* Reflection::findInChain(ConcurrentMap<KeyT, CachedLookup<ValueT>> LookupCache::* cacheMap, size_t hash, KeyT key, FindLocalT findLocal) const {
+        if (!m_lookupFilter.load(std::memory_order_acquire)->mayContain(hash))
+            return nullptr;
+        // Registrations bump the generation after publishing, so the walk sees everything registered by then
+        auto generation = m_chainGeneration.load(std::memory_order_acquire);
+        auto& cache = m_lookupCache.*cacheMap;
+        auto cached = cache.find(key);
+        const ValueT* value = nullptr;
+        if (cached != nullptr && cached->read(generation, value))
+            return value;
+        value = nullptr;
+        m_chainWalks.fetch_add(1, std::memory_order_relaxed);
+        for (auto reflection = this; reflection != nullptr && value == nullptr; reflection = reflection->m_baseReflection.get())
+            value = findLocal(*reflection);
+        // Lookups don't wait for each other to update the cache
+        std::unique_lock<std::mutex> lock(m_lookupCacheMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            if (cached == nullptr)
+                cached = cache.insert(key, CachedLookup<ValueT>()).first;
+            cached->write(generation, value);
+        }
+        return value;
+    }
+
+    const Type* Reflection::findType(std::string_view name) const {
+        // Names of the table skip interning and the lookup cache, others and base reflections fall back to them
+        if (auto nameTable = m_nameTable.load(std::memory_order_acquire)) {
+            auto index = nameTable->find(name);
+            if (index != NameTable::NotFound) {
+                if (auto type = m_typesByName.load(index))
+                    return type;
+            }
+        }
+        // Names of adopted types are in the filter too, so unknown names don't walk the chain
+        if (!m_lookupFilter.load(std::memory_order_acquire)->mayContain(std::hash<std::string_view>()(name)))
+            return nullptr;
+        auto symbol = Symbol::find(name);
+        if (!symbol.empty())
+            return findType(symbol);
+        // Not interned name can only belong to a type that is not registered yet
+        m_chainWalks.fetch_add(1, std::memory_order_relaxed);
+        for (auto reflection = this; reflection != nullptr; reflection = reflection->m_baseReflection.get()) {
+            if (auto typeInfo = reflection->m_lazyTypes.find(name))
+                return reflection->registerLazyType(**typeInfo);
+        }
+        return nullptr;
+    }
+
+    const Type* Reflection::findType(Symbol name) const {
+        return findInChain(&LookupCache::types, name.hash(), name, [name] (const Reflection& reflection) {
+            return reflection.findLocalType(name);
+        });
+    }
+
+    const Type* Reflection::findLocalType(Symbol name) const {
+        if (auto type = m_typesMap.find(name))
+            return *type;
+        auto typeInfo = m_lazyTypes.find(name.str());
+        return typeInfo != nullptr ? registerLazyType(**typeInfo) : nullptr;
+    }
+
+    const Type* Reflection::findType(TypeId typeId) const {
+        auto index = typeId.typeIndex();
+        if (index == 0)
+            return nullptr;
+        for (auto reflection = this; reflection != nullptr; reflection = reflection->m_baseReflection.get()) {
+            auto type = reflection->m_typesByIndex.load(index);
+            if (type == nullptr) {
+                if (auto typeInfo = reflection->m_lazyTypesByIndex.load(index))
+                    type = reflection->registerLazyType(*typeInfo);
+            }
+            // Qualified type ids share the index with the registered one
+            if (type != nullptr)
+                return type->typeId() == typeId ? type : nullptr;
+        }
+        return nullptr;
+    }
+
+    bool Reflection::hasFunction(std::string_view name) const {
+        return hasFunction(Symbol::find(name));
+    }
+
+    bool Reflection::hasFunction(Symbol name) const {
+        return findFunction(name) != nullptr;
+    }
+
+    const Function& Reflection::getFunction(std::string_view name) const {
+        if (auto function = findFunction(Symbol::find(name)))
+            return *function;
         throw MojitoException(concat("Function \"", name, "\" is not registered."));
     }
 
+    const Function& Reflection::getFunction(Symbol name) const {
+        if (auto function = findFunction(name))
+            return *function;
+        throw MojitoException(concat("Function \"", name, "\" is not registered."));
+    }
+
+    const Function* Reflection::findFunction(Symbol name) const {
+        return findInChain(&LookupCache::functions, name.hash(), name, [name] (const Reflection& reflection) -> const Function* {
+            auto function = reflection.m_functionMap.find(name);
+            return function != nullptr ? *function : nullptr;
+        });
+    }
+
+    std::shared_ptr<const FrozenReflection> Reflection::freeze() const {
+        // Snapshot has no lazy registration
+        for (auto reflection = this; reflection != nullptr; reflection = reflection->m_baseReflection.get())
+            reflection->registerLazyTypes();
+        return std::shared_ptr<const FrozenReflection>(new FrozenReflection(shared_from_this()));
+    }
+
+    Reflection::MemoryStats Reflection::memoryStats() const {
+        MemoryStats stats;
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        m_typesMap.forEach([&stats] (Symbol name, const Type* type) {
+            auto typeStats = type->memoryStats();
+            stats.types += typeStats.total();
+            stats.typeNames += type->typeId().name().size();
+            stats.perType.emplace_back(name, typeStats);
+        });
+        m_functionMap.forEach([&stats] (Symbol, const Function*) {
+            stats.functions += sizeof(Function);
+        });
+        stats.registry = m_typesMap.memoryBytes() + m_functionMap.memoryBytes() + m_typesByIndex.memoryBytes()
+                       + m_lazyTypes.memoryBytes() + m_lazyTypesByIndex.memoryBytes() + m_typesByName.memoryBytes();
+        stats.caches = m_convertersCache.memoryBytes();
+        {
+            std::lock_guard<std::mutex> chainLock(m_chainMutex);
+            stats.caches += m_lookupFilters.capacity() * sizeof(std::unique_ptr<LookupFilter>);
+            for (const auto& filter : m_lookupFilters)
+                stats.caches += filter->memoryBytes();
+        }
+        stats.caches += m_lookupCache.types.memoryBytes() + m_lookupCache.functions.memoryBytes();
+        // Types and functions are in the used part of the arena
+        stats.arenaUnused = m_arena.reservedBytes() - m_arena.usedBytes();
+        stats.symbols = Symbol::tableMemoryBytes();
+        return stats;
+    }
+
+    Value Reflection::convert(const AnyArg& anyArg, TypeId targetTypeId) const {
+        auto key = std::make_pair(anyArg.valueRef().typeId(), targetTypeId);
+        if (auto converter = m_convertersCache.find(key)) {
+            m_conversionCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return converter->type->constructors()[converter->constructorIndex].onStackConstructor(anyArg);
+        }
+        m_conversionCacheMisses.fetch_add(1, std::memory_order_relaxed);
+        const auto& type = getType(targetTypeId);
+        auto constructor = type.findConverter(key.first);
+        if (constructor == nullptr)
+            throw MojitoException("No constructor taking the argument");
+        m_convertersCache.insert(key, Converter { &type, static_cast<size_t>(constructor - type.constructors().data()) });
+        return constructor->onStackConstructor(anyArg);
+    }
+
+    bool Reflection::canConvert(TypeId sourceTypeId, TypeId targetTypeId) const {
+        if (m_convertersCache.find(std::make_pair(sourceTypeId, targetTypeId)) != nullptr)
+            return true;
+        auto type = findType(targetTypeId);
+        return type != nullptr && type->findConverter(sourceTypeId) != nullptr;
+    }
+
+    size_t Reflection::TypeIdPairHash::operator()(const std::pair<TypeId, TypeId>& typeIds) const noexcept {
+        std::hash<TypeId> hash;
+        return hash(typeIds.first) * 31 + hash(typeIds.second);
+    }
+
 } // mojito
@@ -1,58 +1,327 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
 #include "TypeId.hpp"
+#include "Symbol.hpp"
+#include "Arena.hpp"
+#include "ConcurrentMap.hpp"
+#include "ConcurrentArray.hpp"
+#include "NameTable.hpp"
+#include "StaticTypeTable.hpp"
 #include "Function.hpp"
 #include "Type.hpp"
 
 namespace mojito {
 
 class Type;
+class FrozenReflection;
 
+// Lookups missing in the reflection are forwarded to the base one. Resolved entries of the whole chain, misses
+// included, are cached in a flattened view. Its entries are outdated once any reflection in the chain registers something:
+// registration is propagated to derived reflections, so a lookup checks a single counter and a single filter.
+// Registration is serialized with a mutex and may run concurrently with lookups, lookups never take locks.
+// Types are published with all their members, so lookups never see a type that is being filled.
 class Reflection : public std::enable_shared_from_this<Reflection> {
+    friend class FrozenReflection; // To copy registered entries
 public:
-    Reflection(const std::shared_ptr<Reflection>& baseReflection = nullptr)
-        : m_baseReflection(baseReflection)
-    {}
-
-    template <typename TypeT, typename ... ArgT>
-    Type& registerType(const std::string& name, const std::vector<TypeId>& parents, const ArgT&... args) {
-        auto typePtr = new Type(getTypeId<TypeT>(), parents, *this);
-        m_typesMap.emplace(name, std::shared_ptr<Type>(typePtr));
-        m_typeNameMap.emplace(getTypeId<TypeT>(), name);
-        return *typePtr;
+    Reflection(const std::shared_ptr<Reflection>& baseReflection = nullptr);
+
+    Reflection(const Reflection&) = delete;
+
+    Reflection& operator=(const Reflection&) = delete;
+
+    ~Reflection();
+
+    // Members are added by the callback before the type is published, so concurrent lookups never see a partially
+    // registered type. Published types are never modified. Registering the same name again returns the registered
+    // type without calling the callback, if it has the same type id.
+    template <typename TypeT, typename AddMembersT, typename = std::enable_if_t<std::is_invocable_v<AddMembersT, Type&>>>
+    const Type& registerType(std::string_view name, const std::vector<TypeId>& parents, AddMembersT addMembers) {
+        auto typeId = getTypeId<TypeT>();
+        if (auto type = findRegisteredType(name, typeId))
+            return *type;
+        auto type = createType(typeId, parents);
+        addMembers(*type);
+        return addType(name, type);
+    }
+
+    template <typename TypeT, typename AddMembersT, typename = std::enable_if_t<std::is_invocable_v<AddMembersT, Type&>>>
+    const Type& registerType(std::string_view name, AddMembersT addMembers) {
+        return registerType<TypeT>(name, {}, addMembers);
     }
 
-    template <typename TypeT, typename ... ArgT>
-    Type& registerType(const std::string& name, const ArgT&... args) {
-        return registerType<TypeT>(name, {}, args...);
+    // Type without members
+    template <typename TypeT>
+    const Type& registerType(std::string_view name, const std::vector<TypeId>& parents = {}) {
+        return registerType<TypeT>(name, parents, [] (Type&) {});
     }
 
-    bool hasType(const std::string& name) const;
+    // Lookup by name doesn't allocate. Lookup by symbol also skips hashing of the name.
+    bool hasType(std::string_view name) const;
+
+    bool hasType(Symbol name) const;
 
     bool hasType(TypeId typeId) const;
 
-    const Type& getType(const std::string& name) const;
+    const Type& getType(std::string_view name) const;
+
+    const Type& getType(Symbol name) const;
 
     const Type& getType(TypeId typeId) const;
 
+    // Non-throwing lookup, returns nullptr if the type is not registered
+    const Type* findType(std::string_view name) const;
+
+    const Type* findType(Symbol name) const;
+
+    const Type* findType(TypeId typeId) const;
+
+    // Registering the same name again returns the registered function
     template <typename FunctionT>
-    const Function& registerFunction(const std::string& name, FunctionT functionPtr) {
-        auto function = std::make_shared<Function>(*this, functionPtr);
-        m_functionMap.emplace(name, function);
+    const Function& registerFunction(std::string_view name, FunctionT functionPtr) {
+        Symbol symbol(name);
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        if (auto function = m_functionMap.find(symbol))
+            return **function;
+        auto function = m_arena.create<Function>(*this, functionPtr);
+        m_functionMap.insert(symbol, function);
+        m_generation.fetch_add(1, std::memory_order_release);
+        auto hash = symbol.hash();
+        propagateRegistration(&hash, 1);
         return *function;
     }
 
-    bool hasFunction(const std::string& name) const;
+    bool hasFunction(std::string_view name) const;
+
+    bool hasFunction(Symbol name) const;
+
+    const Function& getFunction(std::string_view name) const;
+
+    const Function& getFunction(Symbol name) const;
+
+    // Non-throwing lookup, returns nullptr if the function is not registered
+    const Function* findFunction(Symbol name) const;
 
-    const Function& getFunction(const std::string& name) const;
+    // Types of a table emitted by the generator are registered lazily, on the first lookup by name or by type id.
+    // Adoption only indexes the entries. Types registered with the same names are kept, the first adopted entry wins.
+    void adoptTypeTable(const StaticTypeTable& typeTable);
+
+    // Names listed in the table are then looked up with a single hash and compare. The table is usually emitted by the
+    // generator for the whole binary and should outlive the reflection. Can be set once, setting an equal table again
+    // does nothing.
+    void setNameTable(const NameTable& nameTable);
+
+    // Immutable snapshot of the reflection with its base ones, for lookups after registration is finished.
+    // The reflection should be owned by shared_ptr, as the snapshot keeps it alive.
+    std::shared_ptr<const FrozenReflection> freeze() const;
+
+    // Changes every time something is registered in the reflection
+    uint64_t generation() const noexcept { return m_generation.load(std::memory_order_acquire); }
+
+    // Converts the argument with a constructor of the target type. Constructors found are cached by
+    // source and target type ids, so repeated conversions skip both the type lookup and the constructor search.
+    Value convert(const AnyArg& anyArg, TypeId targetTypeId) const;
+
+    bool canConvert(TypeId sourceTypeId, TypeId targetTypeId) const;
+
+    struct ConversionCacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    ConversionCacheStats conversionCacheStats() const {
+        return { m_conversionCacheHits.load(std::memory_order_relaxed), m_conversionCacheMisses.load(std::memory_order_relaxed) };
+    }
+
+    // Lookups by name that passed the filter but not the cache, so they walked the chain of reflections
+    size_t chainWalks() const { return m_chainWalks.load(std::memory_order_relaxed); }
+
+    // Bytes of metadata of this reflection by category, base reflections are not included
+    struct MemoryStats {
+        size_t types = 0; // Registered types with their members, sum of per type stats
+        size_t functions = 0; // Non-member functions
+        size_t registry = 0; // Maps and indices by name and by type id, including adopted tables
+        size_t caches = 0; // Lookup cache and filters, outgrown ones included, and the conversion cache
+        size_t arenaUnused = 0; // Free space at ends of arena blocks and its bookkeeping
+        size_t symbols = 0; // Interned names, shared by all reflections
+        size_t typeNames = 0; // Names of registered type ids, in static storage of the binary, so not in total()
+        std::vector<std::pair<Symbol, Type::MemoryStats>> perType;
+
+        size_t total() const noexcept { return types + functions + registry + caches + arenaUnused + symbols; }
+    };
+
+    // Takes locks of the maps, so it's not for hot paths. Not synchronized with concurrent addition of members.
+    MemoryStats memoryStats() const;
 
 private:
-    std::unordered_map<TypeId, std::string> m_typeNameMap;
-    // FIXME: Use unique_ptr
-    std::unordered_map<std::string, std::shared_ptr<Type>> m_typesMap;
-    // FIXME: Use unique_ptr
-    std::unordered_map<std::string, std::shared_ptr<Function>> m_functionMap;
+    struct TypeIdPairHash {
+        size_t operator()(const std::pair<TypeId, TypeId>& typeIds) const noexcept;
+    };
+
+    struct Converter {
+        const Type* type;
+        size_t constructorIndex;
+    };
+
+    // Bloom filter of hashes of names registered in the reflection and its base ones. When a hash is not in the filter,
+    // there is no such entry for sure. Sized by the number of names, about 1.5% of misses pass it at full capacity.
+    class LookupFilter {
+    public:
+        explicit LookupFilter(size_t capacity)
+            : m_mask(bitsCountFor(capacity) - 1)
+            , m_words(new std::atomic<uint64_t>[(m_mask + 1) / 64]())
+        {}
+
+        void add(size_t hash) noexcept {
+            setBit(firstBit(hash));
+            setBit(secondBit(hash));
+        }
+
+        bool mayContain(size_t hash) const noexcept {
+            return testBit(firstBit(hash)) && testBit(secondBit(hash));
+        }
+
+        // Number of names the filter is sized for
+        size_t capacity() const noexcept { return (m_mask + 1) / BitsPerEntry; }
+
+        size_t memoryBytes() const noexcept { return sizeof(LookupFilter) + (m_mask + 1) / 8; }
+
+    private:
+        static constexpr size_t BitsPerEntry = 16;
+        static constexpr size_t MinBitsCount = 1024;
+
+        size_t m_mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+
+        static size_t bitsCountFor(size_t capacity) noexcept {
+            size_t bitsCount = MinBitsCount;
+            while (bitsCount < capacity * BitsPerEntry)
+                bitsCount *= 2;
+            return bitsCount;
+        }
+
+        void setBit(size_t bit) noexcept { m_words[bit / 64].fetch_or(uint64_t(1) << bit % 64, std::memory_order_relaxed); }
+
+        bool testBit(size_t bit) const noexcept { return m_words[bit / 64].load(std::memory_order_relaxed) & uint64_t(1) << bit % 64; }
+
+        static uint64_t mix(size_t hash) noexcept { return static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull; }
+
+        size_t firstBit(size_t hash) const noexcept { return (mix(hash) >> 36) & m_mask; }
+
+        size_t secondBit(size_t hash) const noexcept { return (mix(hash) >> 8) & m_mask; }
+    };
+
+    // Entry resolved through the chain of reflections, nullptr for misses. Valid while the chain generation is
+    // the one it was resolved in. Outdated entries are updated in place by one writer at a time and read
+    // as a sequence lock, so the cache holds a single entry per looked up name.
+    template <typename ValueT>
+    class CachedLookup {
+    public:
+        CachedLookup() = default;
+
+        // Only for the insertion to the map, before the entry is published
+        CachedLookup(const CachedLookup& other) noexcept
+            : m_chainGeneration(other.m_chainGeneration.load(std::memory_order_relaxed))
+            , m_value(other.m_value.load(std::memory_order_relaxed))
+        {}
+
+        bool read(uint64_t chainGeneration, const ValueT*& value) const noexcept {
+            if (m_chainGeneration.load(std::memory_order_acquire) != chainGeneration)
+                return false;
+            value = m_value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_chainGeneration.load(std::memory_order_relaxed) == chainGeneration;
+        }
+
+        // Writers are serialized by the cache mutex
+        void write(uint64_t chainGeneration, const ValueT* value) const noexcept {
+            if (m_chainGeneration.load(std::memory_order_relaxed) == chainGeneration)
+                return;
+            m_chainGeneration.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_value.store(value, std::memory_order_relaxed);
+            m_chainGeneration.store(chainGeneration, std::memory_order_release);
+        }
+
+    private:
+        mutable std::atomic<uint64_t> m_chainGeneration {0};
+        mutable std::atomic<const ValueT*> m_value {nullptr};
+    };
+
+    struct LookupCache {
+        ConcurrentMap<Symbol, CachedLookup<Type>> types;
+        ConcurrentMap<Symbol, CachedLookup<Function>> functions;
+    };
+
+    mutable std::mutex m_registrationMutex;
+    // Owns registered types and functions, guarded by the registration mutex. Destroyed after the maps referring to them.
+    Arena m_arena;
+    ConcurrentMap<Symbol, Type*> m_typesMap;
+    ConcurrentMap<Symbol, Function*> m_functionMap;
+    // Types by dense type index, see TypeId::typeIndex()
+    ConcurrentArray<const Type> m_typesByIndex;
+    // Adopted types that may be not registered yet, by name and by type index
+    ConcurrentMap<std::string_view, const StaticTypeInfo*> m_lazyTypes;
+    ConcurrentArray<const StaticTypeInfo> m_lazyTypesByIndex;
+    mutable std::mutex m_lazyRegistrationMutex;
+    std::atomic<const NameTable*> m_nameTable {nullptr};
+    // Types by index in the name table
+    ConcurrentArray<const Type> m_typesByName;
     std::shared_ptr<Reflection> m_baseReflection;
+    mutable ConcurrentMap<std::pair<TypeId, TypeId>, Converter, TypeIdPairHash> m_convertersCache;
+    mutable std::atomic<size_t> m_conversionCacheHits {0};
+    mutable std::atomic<size_t> m_conversionCacheMisses {0};
+    mutable std::atomic<size_t> m_chainWalks {0};
+    std::atomic<uint64_t> m_generation {1};
+    // Changes every time something is registered in the reflection or in any of its base ones
+    std::atomic<uint64_t> m_chainGeneration {1};
+    // Guards derived reflections and filters. Locked from base to derived reflections.
+    mutable std::mutex m_chainMutex;
+    // Reflections having this one as the base, they are notified of registrations
+    std::vector<Reflection*> m_derivedReflections;
+    // Filter of names of the whole chain. Outgrown filters may still be read by lookups, so they are kept until
+    // destruction. Capacity doubles, so they take at most as much memory as the current one.
+    std::atomic<const LookupFilter*> m_lookupFilter {nullptr};
+    std::vector<std::unique_ptr<LookupFilter>> m_lookupFilters;
+    size_t m_lookupFilterEntries = 0;
+    mutable LookupCache m_lookupCache;
+    mutable std::mutex m_lookupCacheMutex;
+
+    // Adds names registered in the reflection or in a base one to the filter and invalidates the lookup cache,
+    // of the reflection and of all derived ones
+    void propagateRegistration(const size_t* hashes, size_t count);
+
+    // Replaces the filter with one holding names of the whole chain, with room for at least the given number of names
+    void rebuildLookupFilter(size_t capacity);
+
+    // Returns the type registered with the name, if it has the same type id
+    Type* findRegisteredType(std::string_view name, TypeId typeId) const;
+
+    // Type is not visible to lookups until it's added
+    Type* createType(TypeId typeId, const std::vector<TypeId>& parents);
+
+    // Publishes the type, returns the registered one if the name is taken by the same type id
+    Type& addType(std::string_view name, Type* type);
+
+    const Type* findLocalType(Symbol name) const;
+
+    // Lookups are const, but register adopted types on demand
+    const Type* registerLazyType(const StaticTypeInfo& typeInfo) const;
+
+    void registerLazyTypes() const;
+
+    void addToTypeIndex(const Type& type);
+
+    void addToNameTable(std::string_view name, const Type& type);
+
+    // Returns the dense index of the type, assigning a new one on the first call for the type
+    static uint32_t assignTypeIndex(TypeId typeId);
+
+    template <typename KeyT, typename ValueT, typename FindLocalT>
+    const ValueT* findInChain(ConcurrentMap<KeyT, CachedLookup<ValueT>> LookupCache::* cacheMap, size_t hash, KeyT key, FindLocalT findLocal) const;
 };
 
 } // mojito
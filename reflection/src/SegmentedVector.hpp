@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mojito {
+
+// Vector that never moves its elements, so pointers to them stay valid while it grows (as std::deque does).
+// Elements are kept in segments of doubling size. Nothing is allocated until the first element is added,
+// while std::deque allocates its map and a full block even when empty.
+template <typename T>
+class SegmentedVector {
+    template <typename VectorT, typename ElementT>
+    class Iterator {
+    public:
+        Iterator(VectorT* vector, size_t index) noexcept
+            : m_vector(vector)
+            , m_index(index)
+        {}
+
+        ElementT& operator*() const noexcept { return (*m_vector)[m_index]; }
+
+        ElementT* operator->() const noexcept { return &(*m_vector)[m_index]; }
+
+        Iterator& operator++() noexcept {
+            ++m_index;
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const noexcept { return m_index == other.m_index; }
+
+        bool operator!=(const Iterator& other) const noexcept { return m_index != other.m_index; }
+
+    private:
+        VectorT* m_vector;
+        size_t m_index;
+    };
+
+public:
+    using value_type = T;
+    using iterator = Iterator<SegmentedVector, T>;
+    using const_iterator = Iterator<const SegmentedVector, const T>;
+
+    SegmentedVector() = default;
+
+    SegmentedVector(const SegmentedVector& other) {
+        for (const auto& element : other)
+            push_back(element);
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : m_segments(std::move(other.m_segments))
+        , m_size(other.m_size)
+    {
+        other.m_size = 0;
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& other) {
+        if (this != &other) {
+            clear();
+            for (const auto& element : other)
+                push_back(element);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() { clear(); }
+
+    size_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    T& operator[](size_t index) noexcept {
+        size_t segment, offset;
+        locate(index, segment, offset);
+        return *std::launder(reinterpret_cast<T*>(&m_segments[segment][offset]));
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        size_t segment, offset;
+        locate(index, segment, offset);
+        return *std::launder(reinterpret_cast<const T*>(&m_segments[segment][offset]));
+    }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+
+    iterator end() noexcept { return iterator(this, m_size); }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+
+    template <typename ... ArgT>
+    T& emplace_back(ArgT&& ... args) {
+        size_t segment, offset;
+        locate(m_size, segment, offset);
+        if (segment == m_segments.size())
+            m_segments.emplace_back(new Storage[FirstSegmentSize << segment]);
+        auto element = new (&m_segments[segment][offset]) T(std::forward<ArgT>(args)...);
+        ++m_size;
+        return *element;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+
+    // Bytes of allocated segments, memory owned by elements is not included
+    size_t memoryBytes() const noexcept {
+        auto segmentsBytes = m_segments.empty() ? 0 : ((FirstSegmentSize << m_segments.size()) - FirstSegmentSize) * sizeof(Storage);
+        return segmentsBytes + m_segments.capacity() * sizeof(std::unique_ptr<Storage[]>);
+    }
+
+    void clear() noexcept {
+        for (size_t i = m_size; i > 0; --i)
+            (*this)[i - 1].~T();
+        m_segments.clear();
+        m_size = 0;
+    }
+
+private:
+    static constexpr size_t FirstSegmentSize = 4;
+
+    using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    std::vector<std::unique_ptr<Storage[]>> m_segments;
+    size_t m_size = 0;
+
+    // Segment k starts at FirstSegmentSize * (2^k - 1) and holds FirstSegmentSize * 2^k elements
+    static void locate(size_t index, size_t& segment, size_t& offset) noexcept {
+        auto position = index / FirstSegmentSize + 1;
+        segment = 0;
+        while ((position >> (segment + 1)) != 0)
+            ++segment;
+        offset = index - FirstSegmentSize * ((size_t(1) << segment) - 1);
+    }
+};
+
+} // mojito
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "TypeId.hpp"
+
+namespace mojito {
+
+class Type;
+
+// Type described by a constant table entry. Entries are aggregates of string literals and function pointers,
+// so tables emitted by the generator are constant initialized, placed in read-only data and shared between processes.
+struct StaticTypeInfo {
+    std::string_view name;
+    TypeId (*typeId)() noexcept;
+    // Adds constructors, methods and fields of the type
+    void (*addMembers)(Type& type);
+};
+
+struct StaticTypeTable {
+    const StaticTypeInfo* types = nullptr;
+    size_t size = 0;
+};
+
+} // mojito
@@ -0,0 +1,50 @@
+#include "Symbol.hpp"
+
+#include <memory>
+
+#include "ConcurrentMap.hpp"
+
+namespace mojito {
+
+    // Keys are views of the names owned by the values, so lookup by string_view doesn't allocate or lock.
+    // Defined in the library, so all modules share the same symbols.
+    struct Symbol::Table {
+        ConcurrentMap<std::string_view, std::unique_ptr<Data>> symbols;
+
+        static Table& instance() {
+            static Table table;
+            return table;
+        }
+    };
+
+    Symbol::Symbol(std::string_view name) {
+        auto& table = Table::instance();
+        if (auto data = table.symbols.find(name)) {
+            m_data = data->get();
+            return;
+        }
+        auto data = std::make_unique<Data>(Data { std::string(name), std::hash<std::string_view>()(name) });
+        std::string_view key = data->name;
+        // If another thread interns the same name first, its data is used and this one is dropped
+        m_data = table.symbols.insert(key, std::move(data)).first->get();
+    }
+
+    size_t Symbol::tableMemoryBytes() {
+        auto& table = Table::instance();
+        size_t bytes = table.symbols.memoryBytes();
+        auto inlineCapacity = std::string().capacity();
+        table.symbols.forEach([&bytes, inlineCapacity] (std::string_view, const std::unique_ptr<Data>& data) {
+            bytes += sizeof(Data);
+            // Short names are stored inside of the string
+            if (data->name.capacity() > inlineCapacity)
+                bytes += data->name.capacity() + 1;
+        });
+        return bytes;
+    }
+
+    Symbol Symbol::find(std::string_view name) noexcept {
+        auto data = Table::instance().symbols.find(name);
+        return data != nullptr ? Symbol(data->get()) : Symbol();
+    }
+
+} // mojito
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace mojito {
+
+// Interned name. Equal names share the same storage, so symbols are compared by pointer and their hash
+// is computed only once, on interning. Interned names live until the end of the program.
+class Symbol {
+public:
+    Symbol() = default;
+
+    // Interns the name. Allocates only the first time the name is seen.
+    explicit Symbol(std::string_view name);
+
+    // Returns the symbol of an already interned name or an empty symbol. Never allocates.
+    static Symbol find(std::string_view name) noexcept;
+
+    bool empty() const noexcept { return m_data == nullptr; }
+
+    std::string_view str() const noexcept { return m_data != nullptr ? std::string_view(m_data->name) : std::string_view(); }
+
+    size_t hash() const noexcept { return m_data != nullptr ? m_data->hash : 0; }
+
+    // Bytes of all interned names with the table. Symbols are shared by all reflections.
+    static size_t tableMemoryBytes();
+
+    bool operator==(const Symbol& other) const noexcept { return m_data == other.m_data; }
+
+    bool operator!=(const Symbol& other) const noexcept { return m_data != other.m_data; }
+
+private:
+    struct Table;
+
+    struct Data {
+        std::string name;
+        size_t hash;
+    };
+
+    const Data* m_data = nullptr;
+
+    explicit Symbol(const Data* data) noexcept
+        : m_data(data)
+    {}
+};
+
+inline std::ostream& operator<<(std::ostream& stream, const Symbol& symbol) {
+    return stream << symbol.str();
+}
+
+} // mojito
+
+namespace std {
+
+template <>
+struct hash<mojito::Symbol> {
+    size_t operator()(const mojito::Symbol& symbol) const noexcept {
+        return symbol.hash();
+    }
+};
+
+} // std
@@ -1,12 +1,20 @@
 #pragma once
 
-#include <unordered_map>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <type_traits>
 
 #include "TypeId.hpp"
+#include "Symbol.hpp"
+#include "FlatMap.hpp"
+#include "SegmentedVector.hpp"
 #include "Function.hpp"
+#include "OverloadSet.hpp"
 #include "Constructor.hpp"
 #include "Field.hpp"
+#include "MethodHandle.hpp"
+#include "FieldHandle.hpp"
 
 namespace mojito {
 
@@ -14,6 +22,8 @@ namespace mojito {
 // TODO: Introduce TypeBuilder to get rid of passing type to some member registration functions
 class Type {
     friend class Reflection; // To construct
+    friend class Arena; // To construct in place
+    friend class FrozenReflection; // To copy fields
 public:
     TypeId typeId() const { return m_typeId; }
 
@@ -21,9 +31,28 @@ public:
 
     const std::vector<Constructor>& constructors() const { return m_constructors; }
 
-    const std::unordered_map<std::string, Function>& functionMap() const { return m_functionsMap; }
+    // Overload sets with their names, in order of registration
+    const SegmentedVector<std::pair<Symbol, OverloadSet>>& functionMap() const { return m_functions; }
 
-    const Function& function(const std::string& name) const { return m_functionsMap.at(name); }
+    const OverloadSet& function(std::string_view name) const { return function(Symbol::find(name)); }
+
+    const OverloadSet& function(Symbol name) const { return m_functions[m_functionsIndex.at(name)].second; }
+
+    // Resolves the method once, to call it later without name lookup. Members are stored in segmented vectors, so adding
+    // more members doesn't invalidate handles.
+    MethodHandle methodHandle(std::string_view name) const {
+        if (auto handle = findMethodHandle(name))
+            return handle;
+        throw MojitoException(concat("Method ", name, " is not registered"));
+    }
+
+    // Returns an empty handle if there is no such method
+    MethodHandle findMethodHandle(std::string_view name) const noexcept { return findMethodHandle(Symbol::find(name)); }
+
+    MethodHandle findMethodHandle(Symbol name) const noexcept {
+        auto iter = m_functionsIndex.find(name);
+        return iter != m_functionsIndex.end() ? MethodHandle(&m_functions[iter->second].second) : MethodHandle();
+    }
 
     template <typename ... ArgT>
     Value constructOnStack(ArgT&& ... anyArgs) const {
@@ -40,42 +69,124 @@ public:
          findConstructor<ArgT...>(anyArgs...).inAddressConstructor(address, anyArgs...);
     }
 
+    // Non-throwing versions of construction, see Function::tryInvoke()
+    template <typename ... ArgT>
+    Expected<Value> tryConstructOnStack(ArgT&& ... anyArgs) const {
+        auto constructor = tryFindConstructor<ArgT...>(anyArgs...);
+        if (constructor == nullptr)
+            return Error(ErrorCode::NoConstructor);
+        return constructor->onStackConstructor.tryInvoke(anyArgs...);
+    }
+
+    template <typename ... ArgT>
+    Expected<Value> tryConstructOnHeap(ArgT&& ... anyArgs) const {
+        auto constructor = tryFindConstructor<ArgT...>(anyArgs...);
+        if (constructor == nullptr)
+            return Error(ErrorCode::NoConstructor);
+        return constructor->onHeapConstructor.tryInvoke(anyArgs...);
+    }
+
+    // Constructor taking a single argument of the source type without conversion, used to convert arguments
+    const Constructor* findConverter(TypeId sourceTypeId) const {
+        for (const auto& constructor : m_constructors) {
+            const auto& argumentTypeIds = constructor.onStackConstructor.argumentTypeIds();
+            if (argumentTypeIds.size() == 1 && sourceTypeId.canPassTo(argumentTypeIds.front().decayed()))
+                return &constructor;
+        }
+        return nullptr;
+    }
+
     template <typename ResultT, typename ... ArgT>
     Type& addConstructor() {
         m_constructors.emplace_back(Constructor {
-            Function(m_reflection, static_cast<Value (*) (ArgT...)>([](ArgT...args) { return Value(new ResultT(args...), getTypeId<ResultT>()); }) ),
+            Function(m_reflection, static_cast<Value (*) (ArgT...)>([](ArgT...args) { return Value(std::in_place_type<ResultT>, args...); }) ),
             Function(m_reflection, static_cast<ResultT* (*) (ArgT...)>([](ArgT...args) { return new ResultT(args...); }) ),
             Function(m_reflection, static_cast<void (*) (void*, ArgT...)>([](void* ptr, ArgT...args) { new(ptr) ResultT(args...); }) )});
+        const std::array<TypeId, sizeof...(ArgT)> decayedTypeIds {getTypeId<ArgT>().decayed()...};
+        m_constructorsIndex.emplace(signatureHash(decayedTypeIds), m_constructors.size() - 1);
         return *this;
     }
 
     template <typename FuncT>
-    Type& addFunction(const std::string& name, FuncT func) {
-        m_functionsMap.emplace(name, Function(m_reflection, func) );
+    Type& addFunction(std::string_view name, FuncT func) {
+        overloadSet(Symbol(name)).add(Function(m_reflection, func));
         return *this;
     }
 
+    // Inline member function taking the object reference. Lambdas without captures are called through the function
+    // pointer, captures are kept in the function and have to be trivially copyable and fit in two pointers.
     template <typename TypeT, typename ResultT, typename ... ArgT, typename FuncT>
-    Type& addFunction(const std::string& name, FuncT lambda) {
-        m_functionsMap.emplace(name, Function(m_reflection, std::function<ResultT(TypeT&, ArgT...)>(lambda)));
+    Type& addFunction(std::string_view name, FuncT lambda) {
+        if constexpr (std::is_convertible_v<FuncT, ResultT (*) (TypeT&, ArgT...)>)
+            overloadSet(Symbol(name)).add(Function(m_reflection, Function::InlineMember{}, static_cast<ResultT (*) (TypeT&, ArgT...)>(lambda)));
+        else
+            overloadSet(Symbol(name)).add(Function(m_reflection, Function::InlineMember{}, lambda, Function::MemberSignature<TypeT, ResultT, ArgT...>()));
         return *this;
     }
 
     template <typename TypeT, typename FieldT>
-    Type& addField(const std::string& name, FieldT TypeT::*fieldPtr) {
-        m_fieldsMap.emplace(name, Field(m_reflection, fieldPtr));
+    Type& addField(std::string_view name, FieldT TypeT::*fieldPtr) {
+        if (m_fieldsIndex.emplace(Symbol(name), m_fields.size()).second)
+            m_fields.push_back(Field(m_reflection, fieldPtr));
         return *this;
     }
 
-    const Field& field(const std::string& name) const { return m_fieldsMap.at(name); }
+    const Field& field(std::string_view name) const { return field(Symbol::find(name)); }
+
+    const Field& field(Symbol name) const { return m_fields[m_fieldsIndex.at(name)]; }
+
+    FieldHandle fieldHandle(std::string_view name) const {
+        if (auto handle = findFieldHandle(name))
+            return handle;
+        throw MojitoException(concat("Field ", name, " is not registered"));
+    }
+
+    // Returns an empty handle if there is no such field
+    FieldHandle findFieldHandle(std::string_view name) const noexcept { return findFieldHandle(Symbol::find(name)); }
+
+    FieldHandle findFieldHandle(Symbol name) const noexcept {
+        auto iter = m_fieldsIndex.find(name);
+        return iter != m_fieldsIndex.end() ? FieldHandle(&m_fields[iter->second]) : FieldHandle();
+    }
+
+    // Bytes of metadata of the type by category. Names are interned symbols, they are reported by the reflection.
+    struct MemoryStats {
+        size_t object = 0; // The type itself and its parents list
+        size_t constructors = 0;
+        size_t methods = 0; // Overload sets with their functions
+        size_t fields = 0;
+        size_t indices = 0; // Name and signature indices of members
+
+        size_t total() const noexcept { return object + constructors + methods + fields + indices; }
+    };
+
+    // Not synchronized with concurrent addition of members
+    MemoryStats memoryStats() const noexcept {
+        MemoryStats stats;
+        stats.object = sizeof(Type) + m_parents.capacity() * sizeof(TypeId);
+        stats.constructors = m_constructors.capacity() * sizeof(Constructor);
+        stats.methods = m_functions.memoryBytes();
+        for (const auto& function : m_functions)
+            stats.methods += function.second.memoryBytes();
+        stats.fields = m_fields.memoryBytes();
+        stats.indices = m_constructorsIndex.memoryBytes() + m_functionsIndex.memoryBytes() + m_fieldsIndex.memoryBytes();
+        return stats;
+    }
 
 private:
     TypeId m_typeId;
     std::vector<TypeId> m_parents;
     const Reflection& m_reflection;
     std::vector<Constructor> m_constructors;
-    std::unordered_map<std::string, Function> m_functionsMap;
-    std::unordered_map<std::string, Field> m_fieldsMap;
+    // Constructor indices by hash of decayed argument type ids, so arguments differing from parameters only
+    // in const and reference qualifiers are found too. On hash collision only the first constructor is indexed,
+    // others are found by the compatible match search.
+    FlatMap<size_t, size_t> m_constructorsIndex;
+    // Members are indexed by position, so copies of the type stay consistent
+    SegmentedVector<std::pair<Symbol, OverloadSet>> m_functions;
+    FlatMap<Symbol, size_t> m_functionsIndex;
+    SegmentedVector<Field> m_fields;
+    FlatMap<Symbol, size_t> m_fieldsIndex;
 
     Type(TypeId typeId, const std::vector<TypeId>& parents, const Reflection& reflection)
         : m_typeId(typeId)
@@ -83,13 +194,34 @@ private:
         , m_reflection(reflection)
     {}
 
+    OverloadSet& overloadSet(Symbol name) {
+        auto result = m_functionsIndex.emplace(name, m_functions.size());
+        if (result.second)
+            m_functions.emplace_back(name, OverloadSet());
+        return m_functions[result.first->second].second;
+    }
+
     template <typename ... ArgT>
     const Constructor& findConstructor(const ArgT& ... anyArgs) const {
+        if (auto constructor = tryFindConstructor<ArgT...>(anyArgs...))
+            return *constructor;
+        throw MojitoException("Can't construct");
+    }
+
+    template <typename ... ArgT>
+    const Constructor* tryFindConstructor(const ArgT& ... anyArgs) const {
+        const std::array<TypeId, sizeof...(ArgT)> argumentTypeIds {argumentTypeId(anyArgs)...};
+        const std::array<TypeId, sizeof...(ArgT)> decayedTypeIds {argumentTypeId(anyArgs).decayed()...};
+        auto indexIter = m_constructorsIndex.find(signatureHash(decayedTypeIds));
+        if (indexIter != m_constructorsIndex.end()) {
+            // Same decayed types, the arguments still have to bind without dropping const
+            const auto& constructor = m_constructors[indexIter->second];
+            if (constructor.onStackConstructor.matchesExactly(argumentTypeIds))
+                return &constructor;
+        }
         auto iter = std::find_if(m_constructors.begin(), m_constructors.end(),
                      [&anyArgs...] (const auto& constructor) { return constructor.onStackConstructor.template fitArgs<ArgT...>(anyArgs ...);});
-        if (iter != m_constructors.end())
-            return *iter;
-        throw MojitoException("Can't construct");
+        return iter != m_constructors.end() ? &*iter : nullptr;
     }
 };
 
@@ -0,0 +1,48 @@
+#include "TypeId.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace mojito {
+
+    // Type slots by stable hash, shared by all modules that resolve stableTypeTable() to this definition
+    struct StableTypeTable {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, TypeSlot*> slots;
+    };
+
+    StableTypeTable& stableTypeTable() noexcept {
+        static StableTypeTable table;
+        return table;
+    }
+
+    TypeSlot* canonicalTypeSlot(TypeSlot* slot) noexcept {
+        auto& table = stableTypeTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto iter = table.slots.emplace(slot->nameHash, slot).first;
+        // On collision the type keeps its own slot, registration reports the collision
+        return iter->second->name == slot->name ? iter->second : slot;
+    }
+
+    void registerStableTypeSlot(TypeSlot* slot) {
+        auto& table = stableTypeTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto iter = table.slots.emplace(slot->nameHash, slot).first;
+        if (iter->second->name != slot->name)
+            throw MojitoException(concat("Stable hash collision of types ", iter->second->name, " and ", slot->name));
+    }
+
+    void registerStableTypeId(TypeId typeId) {
+        registerStableTypeSlot(typeId.slot());
+    }
+
+    TypeId TypeId::findByStableHash(uint64_t stableHash) noexcept {
+        auto& table = stableTypeTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto iter = table.slots.find(stableHash);
+        if (iter == table.slots.end())
+            return TypeId();
+        return TypeId(reinterpret_cast<intptr_t>(iter->second), false, false);
+    }
+
+} // mojito
@@ -1,21 +1,88 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <bitset>
+#include <cstdint>
 #include <type_traits>
-#include <regex>
 #include <functional>
-#include <unordered_map>
+#include <string>
+#include <string_view>
 
 #include "Utility.hpp"
 
-#ifndef NDEBUG
-#define DEBUG_TYPE_NAMES
+namespace mojito {
+
+// Name of the type parsed at compile time from the signature of the function
+template <typename T>
+constexpr std::string_view typeName() noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+    // "... typeName() [with T = int; ...]" for gcc and "... typeName() [T = int]" for clang.
+    // Array types have brackets of their own, so the name ends at the last bracket.
+    constexpr std::string_view signature = __PRETTY_FUNCTION__;
+    constexpr auto begin = signature.find("T = ") + 4;
+    constexpr auto separator = signature.find(';', begin);
+    constexpr auto end = separator != std::string_view::npos ? separator : signature.rfind(']');
+#elif defined(_MSC_VER)
+    // "... typeName<int>(void) noexcept"
+    constexpr std::string_view signature = __FUNCSIG__;
+    constexpr auto begin = signature.find("typeName<") + 9;
+    constexpr auto end = signature.rfind(">(");
 #endif
+    return signature.substr(begin, end - begin);
+}
 
-namespace mojito {
+// 64-bit FNV-1a hash of the type name. Unlike addresses, it's the same in all modules and runs,
+// as long as they are built with the same compiler.
+constexpr uint64_t typeNameHash(std::string_view name) noexcept {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto c : name)
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    return hash;
+}
+
+// Static storage behind a type id. Its address identifies the type, it holds the dense index and the name of the type.
+struct TypeSlot {
+    std::atomic<uint32_t> index;
+    std::string_view name;
+    uint64_t nameHash;
+};
+
+class TypeId;
+
+// Stable slots are kept in a single table for the whole process only if all modules resolve stableTypeTable()
+// to one definition. Either link the library into one shared object used by the other modules, or link it into
+// each of them with the function exported (the default) and load them with RTLD_GLOBAL, so the dynamic linker
+// binds all of them to the first loaded one. Don't link with -Bsymbolic or hide the symbol. On Windows define
+// MOJITO_STABLE_TYPES_API as __declspec(dllexport) in the DLL linking the library and as __declspec(dllimport)
+// in the other modules.
+#ifndef MOJITO_STABLE_TYPES_API
+#if defined(__GNUC__)
+#define MOJITO_STABLE_TYPES_API __attribute__((visibility("default")))
+#else
+#define MOJITO_STABLE_TYPES_API
+#endif
+#endif
+
+struct StableTypeTable;
+
+MOJITO_STABLE_TYPES_API StableTypeTable& stableTypeTable() noexcept;
+
+// Returns the slot registered first for the same type name. Used to make type ids of all modules agree,
+// when the linker doesn't merge static variables of templates (Windows DLLs, hidden visibility).
+TypeSlot* canonicalTypeSlot(TypeSlot* slot) noexcept;
+
+// Remembers the slot by the hash of its name. Throws if a slot with another name has the same hash.
+void registerStableTypeSlot(TypeSlot* slot);
+
+// Remembers the type by stable hash. Throws if another type has the same hash.
+// Reflections call it on type registration only when built with MOJITO_STABLE_TYPE_IDS.
+void registerStableTypeId(TypeId typeId);
 
 class TypeId {
     friend struct std::hash<TypeId>; // To calculate hash
+    friend class Reflection; // To assign type index
+    friend void registerStableTypeId(TypeId typeId); // To access the slot
     template <typename T>
     friend TypeId getTypeId() noexcept;
 public:
@@ -27,7 +94,25 @@ public:
             && target.isPointer() == isPointer()
             && (target.isConst() || isConst() == target.isConst());
     }
-    TypeId pureTypeId() { return TypeId(m_bitset, false, false); }
+    // Same type, that can be passed without conversion. Adding const qualifier is allowed.
+    bool canBindTo(const TypeId& target) const noexcept {
+        return (target.m_bitset & ~FlagsSet) == (m_bitset & ~FlagsSet)
+            && target.isPointer() == isPointer()
+            && (target.isConst() || !isConst());
+    }
+    TypeId pureTypeId() const { return TypeId(m_bitset, false, false); }
+    // Name of the type without qualifiers
+    std::string_view name() const noexcept { return isValid() ? slot()->name : std::string_view(); }
+    // Identity of the type without qualifiers, that can be persisted or passed to another process
+    uint64_t stableHash() const noexcept { return isValid() ? slot()->nameHash : 0; }
+    // Type id of a type passed to registerStableTypeId by its stable hash, invalid type id if there is no such type
+    static TypeId findByStableHash(uint64_t stableHash) noexcept;
+    // Type id of the parameter with reference and top level qualifiers removed, as std::decay does
+    TypeId decayed() const noexcept { return isPointer() ? *this : TypeId(m_bitset, false, false); }
+    // Argument is passed without conversion if it has the decayed parameter type, pointers are passed as is
+    bool canPassTo(const TypeId& decayedParameter) const noexcept {
+        return *this == decayedParameter || (isPointer() && decayedParameter.isPointer());
+    }
     bool operator==(const TypeId& other) const noexcept {
         return m_bitset == other.m_bitset;
     }
@@ -37,16 +122,17 @@ public:
 
     bool isValid() const noexcept { return m_bitset != 0; }
 
+    // Dense index assigned on the first registration of the type in any reflection, 0 if it was never registered
+    uint32_t typeIndex() const noexcept {
+        return isValid() ? slot()->index.load(std::memory_order_acquire) : 0;
+    }
+
     TypeId(TypeId typeId, bool pointerFlag, bool constFlag) noexcept
         : TypeId(typeId.m_bitset, pointerFlag, constFlag)
     {}
 
     operator intptr_t() const { return m_bitset; }
 
-#ifdef DEBUG_TYPE_NAMES
-    std::string name;
-#endif
-
 private:
 // Offsets used becase apart of pure type id, bitset also stores flags. Idea is to make type id size of pointer.
     static constexpr size_t PointerFlagIndex = sizeof(intptr_t) * 8 - 1;
@@ -58,16 +144,24 @@ private:
     {}
 
     uintptr_t m_bitset = 0;
+
+    TypeSlot* slot() const noexcept { return reinterpret_cast<TypeSlot*>(m_bitset & ~FlagsSet); }
 };
 
-#ifndef DEBUG_TYPE_NAMES
 static_assert(sizeof(TypeId) == sizeof(intptr_t), "Should fit into intptr_t size.");
-#endif
 
+// Define MOJITO_STABLE_TYPE_IDS in all modules to get the same type ids across modules, that don't share static
+// variables of templates. Costs a guarded static read on each getTypeId().
 template <typename T>
 intptr_t getTypeSerial() noexcept {
-    static int placeholder;
+    // Constant initialized, so access doesn't need a guard
+    static TypeSlot placeholder { {0}, typeName<T>(), typeNameHash(typeName<T>()) };
+#ifdef MOJITO_STABLE_TYPE_IDS
+    static const auto canonicalSlot = canonicalTypeSlot(&placeholder);
+    return reinterpret_cast<intptr_t>(canonicalSlot);
+#else
     return reinterpret_cast<intptr_t>(&placeholder);
+#endif
 }
 
 template <typename T>
@@ -75,30 +169,47 @@ TypeId getTypeId() noexcept {
     TypeId typeId(getTypeSerial<std::remove_pointer_t<std::decay_t<T>>>(),
                   std::is_pointer_v<std::decay_t<T>>,
                   std::is_const_v<std::remove_pointer_t<std::remove_reference_t<T>>>);
-#ifdef DEBUG_TYPE_NAMES
-    // FIXME: Remove name parsing
-    std::regex regex("Type = ([0-9A-Za-z:<>, ]*)");
-    std::smatch match;
-#ifdef __FUNCTION__
-    std::string str(__FUNCTION__);
-#else
-    std::string str(__PRETTY_FUNCTION__);
-#endif
-    std::regex_search(str, match, regex);
-    typeId.name = str
-            + std::to_string(typeId.isPointer())
-            + std::to_string(typeId.isConst());
-#endif
     return typeId;
 }
 
-// FIXME: Remove
-inline std::string getTypeName(TypeId id) noexcept {
-#ifdef DEBUG_TYPE_NAMES
-    return id.name;
-#else
-    return std::to_string(id);
-#endif
+// Type ids of function arguments. Lists are static and shared by all functions with the same argument types,
+// so registered functions don't allocate them.
+class TypeIdList {
+public:
+    TypeIdList() = default;
+
+    template <typename ... T>
+    static TypeIdList of() noexcept {
+        static const std::array<TypeId, sizeof...(T)> typeIds {getTypeId<T>()...};
+        return TypeIdList(typeIds.data(), typeIds.size());
+    }
+
+    const TypeId* begin() const noexcept { return m_data; }
+
+    const TypeId* end() const noexcept { return m_data + m_size; }
+
+    size_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    const TypeId& front() const noexcept { return m_data[0]; }
+
+    const TypeId& operator[](size_t index) const noexcept { return m_data[index]; }
+
+private:
+    const TypeId* m_data = nullptr;
+    size_t m_size = 0;
+
+    TypeIdList(const TypeId* data, size_t size) noexcept
+        : m_data(data)
+        , m_size(size)
+    {}
+};
+
+inline std::string getTypeName(TypeId id) {
+    // Pointers to const have the const in the pure type name already
+    bool constInName = id.name().substr(0, 6) == "const ";
+    return concat(id.isConst() && !constInName ? "const " : "", id.name(), id.isPointer() ? "*" : "");
 }
 
 } // mojito
@@ -107,7 +218,25 @@ namespace std {
 template <>
 struct hash <mojito::TypeId> {
     size_t operator()(const mojito::TypeId& typeId) const noexcept {
-        return static_cast<size_t>(typeId.m_bitset);
+        // Placeholder addresses have zero low bits because of alignment and flags in the top bits, so bits are mixed
+        auto bits = static_cast<uint64_t>(typeId.m_bitset);
+        bits ^= bits >> 33;
+        bits *= 0xff51afd7ed558ccdull;
+        bits ^= bits >> 33;
+        return static_cast<size_t>(bits);
     }
 };
 } // std
+
+namespace mojito {
+
+// Hash of a function signature by its argument type ids
+template <typename TypeIdsT>
+size_t signatureHash(const TypeIdsT& typeIds) noexcept {
+    size_t hash = typeIds.size();
+    for (const auto& typeId : typeIds)
+        hash ^= std::hash<TypeId>()(typeId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+} // mojito
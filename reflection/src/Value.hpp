@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 
 #include "ValueRef.hpp"
 #include "TypeId.hpp"
@@ -31,26 +32,44 @@ struct is_assignable<T, U, decltype(std::declval<T>() = std::declval<U>(), void(
 CHECK_MEMBER_FUNC(HasCopyConstructor, C(std::declval<C>()))
 CHECK_MEMBER_FUNC(HasCopyAssignOperator, (std::declval<C>() = std::declval<C>(), void() ) )
 CHECK_MEMBER_FUNC(HasMoveConstructor, C(std::move(std::declval<C>())))
-CHECK_MEMBER_FUNC(HasMoveAssignOperator, std::declval<C>() = std::move(std::declval<C>()))
 
+// Lifecycle operations of a type. There is a single immutable table per type, shared by all values of the type.
+// Operations take the value buffer to know whether the object is stored inline or on heap.
+// Non-owning values have own table per type, which doesn't delete the object and copies the reference.
+struct ValueOperations {
+    bool ownsObject;
+    void (*deleteObject) (void* obj, const void* buffer);
+    void* (*copyObject) (void* buffer, const void* obj);
+    void (*copyAssignObject) (void* to, const void* from);
+    void* (*moveObject) (void* buffer, void* obj);
+};
+
+// Owning value of any type. It takes five words: object pointer and type id of ValueRef, pointer to the shared
+// operations table (which also tells owning values from references) and a two word inline buffer.
+// The buffer keeps small objects off the heap, the pointer has to stay, so voidPointer() remains a plain load.
 class Value : public ValueRef {
+public:
+    // Small nothrow movable objects (scalars, pointers, small PODs) are stored inline, others are allocated on heap
+    static constexpr size_t BufferSize = 2 * sizeof(void*);
+    static constexpr size_t BufferAlignment = alignof(void*);
+
+    template <typename T>
+    static constexpr bool fitsBuffer() {
+        return sizeof(T) <= BufferSize && alignof(T) <= BufferAlignment && std::is_nothrow_move_constructible_v<T>;
+    }
+
 private:
-    std::function<void(void*)> m_deleteObject;
-    std::function<void*(const void*)> m_copyObject;
-    std::function<void(void*, const void*)> m_copyAssignObject;
-    std::function<void*(const void*)> m_moveObject;
-    std::function<void(void*, const void*)> m_moveAssignObject;
+    const ValueOperations* m_operations = nullptr;
+    alignas(BufferAlignment) unsigned char m_buffer[BufferSize];
+
 public:
-    void* callCopyConstructor(const Value& other) {
+    Value(const Value& other) : ValueRef(nullptr, other.typeId()) {
         if (other.voidPointer() == nullptr)
             throw MojitoException("Source value is not initialized");
-        if (other.m_copyObject == nullptr)
+        if (other.m_operations->copyObject == nullptr)
             throw MojitoException("Value doesn't have a copy constructor");
-        return other.m_copyObject(other.voidPointer());
-    }
-
-    Value(const Value& other) : ValueRef(callCopyConstructor(other), other.typeId()) {
-        copyConstructors(other);
+        setValuePtr(other.m_operations->copyObject(m_buffer, other.voidPointer()), other.typeId());
+        m_operations = other.m_operations;
     }
     
     Value& operator=(const Value& other) {
@@ -58,64 +77,55 @@ public:
             throw MojitoException("Source value is not initialized");
         if (other.typeId() != typeId())
             throw MojitoException("Assignment of values of different types is not supported yet");
-        if (other.m_copyAssignObject == nullptr)
+        if (other.m_operations->copyAssignObject == nullptr)
             throw MojitoException("Value doesn't have a copy assignment operator");
         if (voidPointer() == nullptr)
             throw MojitoException("Invalid value");
-        other.m_copyAssignObject(voidPointer(), other.voidPointer());
+        other.m_operations->copyAssignObject(voidPointer(), other.voidPointer());
         return *this;
     }
     
-    void* callMoveConstructor(const Value& other) {
-        if (other.voidPointer() == nullptr)
-            throw MojitoException("Source value is not initialized");
-        if (other.m_moveObject == nullptr)
-            throw MojitoException("Value doesn't have a move constructor");
-        return other.m_moveObject(other.voidPointer());
+    // Takes over heap allocated object or relocates inline one without allocation. Source value is left empty.
+    Value(Value&& other) noexcept : ValueRef(nullptr, other.typeId()) {
+        takeOver(other);
     }
     
-    Value(Value&& other) : ValueRef(callMoveConstructor(other), other.typeId()) {
-        copyConstructors(other);
-    }
-    
-    Value& operator=(Value&& other) {
-        if (other.voidPointer() == nullptr)
-            throw MojitoException("Source value is not initialized");
-        if (other.typeId() != typeId())
-            throw MojitoException("Assignment of values of different types is not supported yet");
-        if (other.m_moveAssignObject == nullptr)
-            throw MojitoException("Value doesn't have a move assignment operator");
-        if (voidPointer() == nullptr)
-            throw MojitoException("Invalid value");
-        other.m_moveAssignObject(voidPointer(), other.voidPointer());
+    // Releases current object and takes over the other one, so values of different types can be move assigned
+    Value& operator=(Value&& other) noexcept {
+        if (&other != this) {
+            reset();
+            setValuePtr(nullptr, other.typeId());
+            takeOver(other);
+        }
         return *this;
     }
     
     ~Value() {
-        if (voidPointer() != nullptr)
-            m_deleteObject(voidPointer());
+        reset();
     }
     
+    // Takes ownership of heap allocated object
     template <typename T, typename = std::enable_if_t<!std::is_convertible<T, Value>::value>>
     Value(T* value, TypeId typeId)
         : ValueRef(value, typeId)
+        , m_operations(operationsOf<T>())
+    {}
+
+    // Constructs object in place, inline if it fits the buffer
+    template <typename T, typename ... ArgT>
+    Value(std::in_place_type_t<T>, ArgT&& ... args)
+        : ValueRef(nullptr, getTypeId<T>())
+        , m_operations(operationsOf<T>())
     {
-        if constexpr (! std::is_same_v<void, T>) {
-            m_deleteObject = [](void* obj) { delete static_cast<T*>(obj); };
-            if constexpr (HasCopyConstructor<T>::value)
-                m_copyObject = [](const void* obj) -> void* { return new T(*static_cast<const T*>(obj)); };
-            if constexpr (HasCopyAssignOperator<T>::value)
-                m_copyAssignObject = [](void* to, const void* from){ *static_cast<T*>(to) = *static_cast<const T*>(from); };
-            if constexpr (HasMoveConstructor<T>::value)
-                m_moveObject = [](const void* obj) -> void* { return new T(std::move(*static_cast<const T*>(obj))); };
-            if constexpr (HasMoveAssignOperator<T>::value)
-                m_moveAssignObject = [](void* to, const void* from){ *static_cast<T*>(to) = std::move(*static_cast<const T*>(from)); };
-        }
+        if constexpr (fitsBuffer<T>())
+            setValuePtr(new (m_buffer) T(std::forward<ArgT>(args)...), typeId());
+        else
+            setValuePtr(new T(std::forward<ArgT>(args)...), typeId());
     }
 
     template <typename T,typename = std::enable_if_t<!std::is_convertible<T, Value>::value>>
     Value(T&& value)
-        : Value(new std::decay_t<T>(std::forward<T>(value)), getTypeId<std::decay_t<T>>())
+        : Value(std::in_place_type<std::decay_t<T>>, std::forward<T>(value))
     {
     }
 
@@ -128,18 +138,95 @@ public:
     Value addressOf() {
         if (typeId().isPointer())
             throw MojitoException("Address of pointer is not supported yet!");
-        return Value(new void*(const_cast<void*>(voidPointer())), TypeId(typeId(), true, typeId().isConst()));
+        Value pointer(std::in_place_type<void*>, const_cast<void*>(voidPointer()));
+        pointer.setValuePtr(pointer.voidPointer(), TypeId(typeId(), true, typeId().isConst()));
+        return pointer;
     }
 
     static Value makeVoid() { return Value{static_cast<void*>(nullptr), getTypeId<void>()}; }
 
+    // Non-owning value referring to the object. Copies of the value refer to the same object.
+    // Constness of the object is not kept in the type id, as for ValueRef made of a const object.
+    template <typename T>
+    static Value makeReference(T& object) {
+        using ObjectT = std::remove_const_t<T>;
+        return Value(&ReferenceOperations<ObjectT>, const_cast<ObjectT*>(&object), getTypeId<ObjectT>());
+    }
+
+    bool isReference() const noexcept { return m_operations != nullptr && !m_operations->ownsObject; }
+
 private:
-    void copyConstructors(const Value& other) {
-        m_deleteObject = other.m_deleteObject;
-        m_copyObject = other.m_copyObject;
-        m_copyAssignObject = other.m_copyAssignObject;
-        m_moveObject = other.m_moveObject;
-        m_moveAssignObject = other.m_moveAssignObject;
+    Value(const ValueOperations* operations, void* pointer, TypeId typeId)
+        : ValueRef(pointer, typeId)
+        , m_operations(operations)
+    {}
+
+    void takeOver(Value& other) noexcept {
+        m_operations = other.m_operations;
+        if (other.voidPointer() == other.m_buffer) {
+            setValuePtr(m_operations->moveObject(m_buffer, other.voidPointer()), typeId());
+            other.reset();
+        } else {
+            setValuePtr(other.voidPointer(), typeId());
+        }
+        other.setValuePtr(nullptr, other.typeId());
+        other.m_operations = nullptr;
+    }
+
+    void reset() noexcept {
+        if (voidPointer() != nullptr)
+            m_operations->deleteObject(voidPointer(), m_buffer);
+    }
+
+    template <typename T>
+    static const ValueOperations* operationsOf() {
+        if constexpr (std::is_same_v<void, T>)
+            return nullptr;
+        else
+            return &Operations<T>;
+    }
+
+    template <typename T>
+    static constexpr ValueOperations makeOperations() {
+        ValueOperations operations {};
+        operations.ownsObject = true;
+        operations.deleteObject = [](void* obj, const void* buffer) {
+            if (obj == buffer)
+                static_cast<T*>(obj)->~T();
+            else
+                delete static_cast<T*>(obj);
+        };
+        if constexpr (HasCopyConstructor<T>::value)
+            operations.copyObject = [](void* buffer, const void* obj) -> void* { return construct<T>(buffer, *static_cast<const T*>(obj)); };
+        if constexpr (HasCopyAssignOperator<T>::value)
+            operations.copyAssignObject = [](void* to, const void* from){ *static_cast<T*>(to) = *static_cast<const T*>(from); };
+        if constexpr (HasMoveConstructor<T>::value)
+            operations.moveObject = [](void* buffer, void* obj) -> void* { return construct<T>(buffer, std::move(*static_cast<T*>(obj))); };
+        return operations;
+    }
+
+    template <typename T>
+    static constexpr ValueOperations makeReferenceOperations() {
+        auto operations = makeOperations<T>();
+        operations.ownsObject = false;
+        operations.deleteObject = [](void*, const void*) {};
+        operations.copyObject = [](void*, const void* obj) { return const_cast<void*>(obj); };
+        operations.moveObject = [](void*, void* obj) { return obj; };
+        return operations;
+    }
+
+    template <typename T>
+    static constexpr ValueOperations Operations = makeOperations<T>();
+
+    template <typename T>
+    static constexpr ValueOperations ReferenceOperations = makeReferenceOperations<T>();
+
+    template <typename T, typename ArgT>
+    static void* construct(void* buffer, ArgT&& arg) {
+        if constexpr (fitsBuffer<T>())
+            return new (buffer) T(std::forward<ArgT>(arg));
+        else
+            return new T(std::forward<ArgT>(arg));
     }
 };
 
@@ -35,10 +35,19 @@ public:
         , m_typeId(value.typeId())
     {}
 
+    // Returns nullptr instead of throwing if there is no trivial conversion. Const types bind to non-const values.
+    template <typename T>
+    std::remove_reference_t<T>* tryAs() const noexcept {
+        auto typeId = getTypeId<T>();
+        if (!m_typeId.canBindTo(typeId) && !(typeId.isPointer() && m_typeId.isPointer()))
+            return nullptr;
+        return static_cast<std::remove_reference_t<T>*>(const_cast<void*>(m_valuePtr));
+    }
+
     template <typename T>
     T& as() const {
         auto typeId = getTypeId<T>();
-        if (typeId != m_typeId && !(typeId.isPointer() && m_typeId.isPointer()))
+        if (!m_typeId.canBindTo(typeId) && !(typeId.isPointer() && m_typeId.isPointer()))
             throw MojitoException(concat(
                     "No trivial conversion from ", getTypeName(m_typeId), " to ", getTypeName(typeId)));
         return *static_cast<std::remove_reference_t<T>*>(const_cast<void*>(m_valuePtr));
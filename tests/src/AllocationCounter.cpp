@@ -0,0 +1,37 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocationCount { 0 };
+static std::atomic<size_t> allocationBytes { 0 };
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    allocationBytes += size;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+AllocationCounter::AllocationCounter()
+    : m_startCount(allocationCount)
+    , m_startBytes(allocationBytes)
+{}
+
+size_t AllocationCounter::allocations() const {
+    return allocationCount - m_startCount;
+}
+
+size_t AllocationCounter::bytes() const {
+    return allocationBytes - m_startBytes;
+}
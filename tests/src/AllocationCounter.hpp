@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts global operator new calls made since construction. Used to check that hot paths don't allocate.
+class AllocationCounter {
+public:
+    AllocationCounter();
+
+    size_t allocations() const;
+
+    // Total size of allocations, memory freed meanwhile is not subtracted
+    size_t bytes() const;
+
+private:
+    size_t m_startCount;
+    size_t m_startBytes;
+};
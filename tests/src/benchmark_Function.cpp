@@ -0,0 +1,55 @@
+#include <catch.h>
+
+#include "Function.hpp"
+#include "Type.hpp"
+#include "BasicTypesReflection.hpp"
+
+using namespace mojito;
+
+// Benchmarks of reflective calls. Build tests with NDEBUG to get meaningful numbers,
+// otherwise debug type names dominate.
+
+static int accumulator = 0;
+
+static void accumulate(int a, int b) {
+    accumulator += a * b;
+}
+
+// Invoker as it was implemented before thunks: std::function wrapping a lambda that captures
+// the reflection and the function pointer, arguments are passed in a heap allocated vector.
+using LegacyInvoker = std::function<Value(const std::vector<AnyArg>& anyArgs)>;
+
+static LegacyInvoker makeLegacyInvoker(const Reflection& reflection, void (* func) (int, int)) {
+    return [func, &reflection] (const std::vector<AnyArg>& anyArgs) -> Value {
+        return func(anyArgs[0].as<int>(reflection), anyArgs[1].as<int>(reflection)), Value::makeVoid();
+    };
+}
+
+TEST_CASE("Function_benchmark", "[.benchmark]") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& function = reflection->registerFunction("accumulate", &accumulate);
+    auto legacyInvoker = makeLegacyInvoker(*reflection, &accumulate);
+    auto boundFunction = function.bind<void(int, int)>();
+    const int iterations = 100000;
+
+    accumulator = 0;
+    BENCHMARK("std::function invoker") {
+        for (int i = 0; i < iterations; ++i)
+            legacyInvoker(std::vector<AnyArg>{ AnyArg(i), AnyArg(2) });
+    }
+    auto legacyResult = accumulator;
+
+    accumulator = 0;
+    BENCHMARK("Thunk invoker") {
+        for (int i = 0; i < iterations; ++i)
+            function(i, 2);
+    }
+    REQUIRE(accumulator == legacyResult);
+
+    accumulator = 0;
+    BENCHMARK("Bound function") {
+        for (int i = 0; i < iterations; ++i)
+            boundFunction(i, 2);
+    }
+    REQUIRE(accumulator == legacyResult);
+}
@@ -0,0 +1,243 @@
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <catch.h>
+
+#include "Reflection.hpp"
+#include "NameTable.hpp"
+#include "PerfectHash.hpp"
+#include "StaticTypeTable.hpp"
+#include "BasicTypesReflection.hpp"
+#include "AllocationCounter.hpp"
+
+using namespace mojito;
+
+// Lookup latency with a large number of registered types. Build tests with NDEBUG to get meaningful numbers.
+
+template <size_t Index>
+struct BenchmarkType {};
+
+// Instantiating a distinct C++ type per registered type is too slow to compile, so names are registered
+// for a few C++ types in turn. Name lookups see all of them, type id lookups see the last registered ones.
+static constexpr size_t BenchmarkTypesCount = 10240;
+
+template <size_t ... Index>
+static std::vector<TypeId> registerBenchmarkTypes(Reflection& reflection, const std::vector<std::string>& names, std::index_sequence<Index...>) {
+    for (size_t i = 0; i < names.size(); i += sizeof...(Index))
+        (reflection.registerType<BenchmarkType<Index>>(names[i + Index]), ...);
+    return { getTypeId<BenchmarkType<Index>>()... };
+}
+
+static void accumulateFound() {}
+
+template <size_t Index>
+static void addBenchmarkTypeMembers(Type& type) {
+    type.addConstructor<BenchmarkType<Index>>()
+        .addFunction("accumulateFound", &accumulateFound);
+}
+
+// Entries as the generator emits them in static tables mode
+template <size_t ... Index>
+static std::vector<StaticTypeInfo> benchmarkTypeInfos(const std::vector<std::string>& names, std::index_sequence<Index...>) {
+    std::vector<StaticTypeInfo> typeInfos;
+    for (size_t i = 0; i < names.size(); i += sizeof...(Index))
+        (typeInfos.push_back({ names[i + Index], &getTypeId<BenchmarkType<Index>>, &addBenchmarkTypeMembers<Index> }), ...);
+    return typeInfos;
+}
+
+template <size_t ... Index>
+static void registerBenchmarkTypesWithMembers(Reflection& reflection, const std::vector<std::string>& names, std::index_sequence<Index...>) {
+    for (size_t i = 0; i < names.size(); i += sizeof...(Index))
+        (reflection.registerType<BenchmarkType<Index>>(names[i + Index], &addBenchmarkTypeMembers<Index>), ...);
+}
+
+// Startup cost of a binary linking many reflected types, while the process uses a few of them
+TEST_CASE("Reflection_startupBenchmark", "[.benchmark]") {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < BenchmarkTypesCount; ++i)
+        names.push_back(concat("StartupType", i));
+    auto typeInfos = benchmarkTypeInfos(names, std::make_index_sequence<64>());
+    StaticTypeTable typeTable { typeInfos.data(), typeInfos.size() };
+    const size_t usedTypesCount = 16;
+
+    size_t found = 0;
+    BENCHMARK("Eager registration") {
+        auto reflection = std::make_shared<Reflection>();
+        registerBenchmarkTypesWithMembers(*reflection, names, std::make_index_sequence<64>());
+        for (size_t i = 0; i < usedTypesCount; ++i)
+            found += reflection->hasType(names[i * 97]);
+    }
+    REQUIRE(found == usedTypesCount);
+
+    found = 0;
+    BENCHMARK("Lazy registration from static table") {
+        auto reflection = std::make_shared<Reflection>();
+        reflection->adoptTypeTable(typeTable);
+        for (size_t i = 0; i < usedTypesCount; ++i)
+            found += reflection->hasType(names[i * 97]);
+    }
+    REQUIRE(found == usedTypesCount);
+}
+
+TEST_CASE("Reflection_lookupBenchmark", "[.benchmark]") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    std::vector<std::string> names;
+    std::vector<Symbol> symbols;
+    for (size_t i = 0; i < BenchmarkTypesCount; ++i) {
+        names.push_back(concat("BenchmarkType", i));
+        symbols.emplace_back(names.back());
+    }
+    auto typeIds = registerBenchmarkTypes(*reflection, names, std::make_index_sequence<64>());
+    // Node based map, as registry was implemented before
+    std::unordered_map<Symbol, const Type*> legacyMap;
+    for (auto symbol : symbols)
+        legacyMap.emplace(symbol, &reflection->getType(symbol));
+    const int rounds = 10;
+
+    size_t found = 0;
+    BENCHMARK("std::unordered_map by Symbol") {
+        for (int round = 0; round < rounds; ++round) {
+            for (auto symbol : symbols)
+                found += legacyMap.find(symbol) != legacyMap.end();
+        }
+    }
+    REQUIRE(found == symbols.size() * rounds);
+
+    found = 0;
+    BENCHMARK("Reflection::findType by TypeId") {
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < BenchmarkTypesCount; ++i)
+                found += reflection->findType(typeIds[i % typeIds.size()]) != nullptr;
+        }
+    }
+    REQUIRE(found == BenchmarkTypesCount * rounds);
+
+    found = 0;
+    BENCHMARK("Reflection::findType by Symbol") {
+        for (int round = 0; round < rounds; ++round) {
+            for (auto symbol : symbols)
+                found += reflection->findType(symbol) != nullptr;
+        }
+    }
+    REQUIRE(found == symbols.size() * rounds);
+
+    found = 0;
+    BENCHMARK("Reflection::hasType by name") {
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& name : names)
+                found += reflection->hasType(name);
+        }
+    }
+    REQUIRE(found == names.size() * rounds);
+
+    // Registered in an unrelated reflection, so the id has a type index which this chain doesn't know
+    auto otherReflection = std::make_shared<Reflection>();
+    otherReflection->registerType<BenchmarkType<64>>("OtherBenchmarkType");
+    auto missTypeId = getTypeId<BenchmarkType<64>>();
+    REQUIRE(missTypeId.typeIndex() != 0);
+    found = 0;
+    BENCHMARK("Reflection::hasType miss") {
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < BenchmarkTypesCount; ++i)
+                found += reflection->hasType(missTypeId);
+        }
+    }
+    REQUIRE(found == 0);
+
+    // Same names with the table the generator emits for them
+    std::vector<uint64_t> hashes;
+    for (const auto& name : names)
+        hashes.push_back(typeNameHash(name));
+    PerfectHash perfectHash(hashes);
+    std::vector<std::string_view> tableNames(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+        tableNames[perfectHash.slot(hashes[i])] = names[i];
+    NameTable nameTable { perfectHash.displacements().data(), perfectHash.displacements().size(), tableNames.data(), tableNames.size() };
+    reflection->setNameTable(nameTable);
+
+    found = 0;
+    BENCHMARK("Reflection::hasType by name with name table") {
+        for (int round = 0; round < rounds; ++round) {
+            for (const auto& name : names)
+                found += reflection->hasType(name);
+        }
+    }
+    REQUIRE(found == names.size() * rounds);
+}
+
+// Lookups from many threads while another thread keeps registering functions
+TEST_CASE("Reflection_contentionBenchmark", "[.benchmark]") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    std::vector<std::string> names;
+    std::vector<Symbol> symbols;
+    for (size_t i = 0; i < 1024; ++i) {
+        names.push_back(concat("ContentionType", i));
+        symbols.emplace_back(names.back());
+    }
+    auto typeIds = registerBenchmarkTypes(*reflection, names, std::make_index_sequence<64>());
+    const size_t lookupsPerThread = 100000;
+
+    for (size_t threadsCount = 1; threadsCount <= 64; threadsCount *= 2) {
+        std::atomic<bool> done {false};
+        std::thread writer([&reflection, &done] {
+            for (size_t i = 0; !done.load(std::memory_order_relaxed); ++i)
+                reflection->registerFunction(concat("contentionFunc", i), &accumulateFound);
+        });
+        std::atomic<size_t> found {0};
+        BENCHMARK(concat("Lookups from ", threadsCount, " threads")) {
+            std::vector<std::thread> readers;
+            for (size_t thread = 0; thread < threadsCount; ++thread) {
+                readers.emplace_back([&, thread] {
+                    size_t threadFound = 0;
+                    for (size_t i = 0; i < lookupsPerThread; ++i) {
+                        auto index = (i + thread * 7) % symbols.size();
+                        threadFound += reflection->findType(symbols[index]) != nullptr;
+                        threadFound += reflection->findType(typeIds[index % typeIds.size()]) != nullptr;
+                    }
+                    found += threadFound;
+                });
+            }
+            for (auto& reader : readers)
+                reader.join();
+        }
+        done = true;
+        writer.join();
+        REQUIRE(found == threadsCount * lookupsPerThread * 2);
+    }
+}
+
+// Heap cost of registered metadata. Names are interned before counting, as symbols are shared by all reflections.
+TEST_CASE("Reflection_memoryBenchmark", "[.benchmark]") {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < BenchmarkTypesCount; ++i)
+        names.push_back(concat("MemoryType", i));
+    for (const auto& name : names)
+        Symbol symbol(name);
+    Symbol("accumulateFound");
+
+    AllocationCounter allocationCounter;
+    auto reflection = std::make_shared<Reflection>();
+    registerBenchmarkTypesWithMembers(*reflection, names, std::make_index_sequence<64>());
+    auto allocations = allocationCounter.allocations();
+    auto bytes = allocationCounter.bytes();
+    WARN("Registered " << names.size() << " types with a constructor and a method: "
+         << bytes / names.size() << " bytes and " << static_cast<double>(allocations) / names.size() << " allocations per type");
+    REQUIRE(reflection->hasType(names.back()));
+    // Regression bounds, about a fifth above the current cost
+    REQUIRE(bytes / names.size() <= 1536);
+    REQUIRE(allocations <= names.size() * 8);
+
+    auto stats = reflection->memoryStats();
+    auto typeStats = stats.perType.front().second;
+    WARN("Reported per type: " << stats.types / names.size() << " bytes of types ("
+         << typeStats.object << " object, " << typeStats.constructors << " constructors, " << typeStats.methods << " methods, "
+         << typeStats.fields << " fields, " << typeStats.indices << " indices), "
+         << stats.registry / names.size() << " bytes of registry, " << stats.caches / names.size() << " bytes of caches");
+    // Symbols were interned before counting, the rest of the report has to account for the measured heap
+    auto reportedBytes = stats.total() - stats.symbols;
+    INFO("Reported " << reportedBytes << " bytes, measured " << bytes << " bytes");
+    REQUIRE(reportedBytes <= bytes);
+    REQUIRE(reportedBytes >= bytes * 9 / 10);
+    REQUIRE(stats.perType.size() == names.size());
+}
@@ -4,6 +4,7 @@
 #include "Function.hpp"
 #include "Type.hpp"
 #include "BasicTypesReflection.hpp"
+#include "AllocationCounter.hpp"
 
 using namespace mojito;
 
@@ -94,6 +95,49 @@ TEST_CASE("Function_refReturnFunc") {
     auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
     reflection->registerFunction("refReturnFunc", &refReturnFunc);
     REQUIRE(reflection->getFunction("refReturnFunc")().as<TestClass&>().m_c == 1000);
+    REQUIRE(reflection->getFunction("refReturnFunc").resultKind() == Function::ResultKind::Reference);
+    auto result = reflection->getFunction("refReturnFunc")();
+    auto resultCopy = result;
+    REQUIRE(result.isReference());
+    REQUIRE(&result.as<TestClass&>() == &refReturnFunc());
+    REQUIRE(&resultCopy.as<TestClass&>() == &refReturnFunc());
+}
+
+static const std::string& constRefReturnFunc() {
+    static const std::string text("constant text");
+    return text;
+}
+
+TEST_CASE("Function_constRefReturnFunc") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& function = reflection->registerFunction("constRefReturnFunc", &constRefReturnFunc);
+    auto result = function();
+    REQUIRE(result.isReference());
+    REQUIRE(result.as<std::string>() == "constant text");
+    REQUIRE(&result.as<const std::string&>() == &constRefReturnFunc());
+}
+
+static const std::string& identityFunc(const std::string& text) {
+    return text;
+}
+
+TEST_CASE("Function_refReturnFunc temporary arguments") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& function = reflection->registerFunction("identityFunc", &identityFunc);
+
+    // Arguments living after the call are referred to
+    std::string text("text longer than the small string buffer");
+    auto result = function(text);
+    REQUIRE(result.isReference());
+    REQUIRE(&result.as<const std::string&>() == &text);
+
+    // Converted and temporary arguments are destroyed with the call, so the result is copied
+    auto converted = function("literal longer than the small string buffer");
+    REQUIRE(!converted.isReference());
+    REQUIRE(converted.as<std::string>() == "literal longer than the small string buffer");
+    auto temporary = function(std::string("temporary longer than the small string buffer"));
+    REQUIRE(!temporary.isReference());
+    REQUIRE(temporary.as<std::string>() == "temporary longer than the small string buffer");
 }
 
 static int multiArgFunc(int a, TestClass test, TestClass* testPtr, TestClass& testRef) {
@@ -111,3 +155,77 @@ TEST_CASE("Function_multiArgFunc") {
     REQUIRE(test2.m_c == 11);
     REQUIRE(test3.m_c == 11);
 }
+
+static void eightArgFunc(int a, int b, char c, double d, TestClass* testPtr, const TestClass* testConstPtr, TestClass& testRef, TestClass test) {
+    testRef.m_c = testPtr->m_c = a + b + c + static_cast<int>(d) + testConstPtr->m_c + test.m_c;
+}
+
+TEST_CASE("Function_zeroAllocationCall") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& function = reflection->registerFunction("eightArgFunc", &eightArgFunc);
+    const auto& resultFunction = reflection->registerFunction("multiArgFunc", &multiArgFunc);
+    Function method(*reflection, &TestClass::testMethod);
+    Function constMethod(*reflection, &TestClass::testMethodConst);
+    TestClass test1(1);
+    TestClass test2(2);
+    TestClass test3(3);
+    int a = 10;
+    // Checked in every build mode, nothing on the call path allocates
+    AllocationCounter allocationCounter;
+    function(a, 20, 'a', 1.0, &test1, &test2, test3, test3);
+    auto result = resultFunction(a, test1, &test2, test2);
+    auto methodResult = method(test2, a, 3);
+    auto constMethodResult = constMethod(test2, a, 3);
+    REQUIRE(allocationCounter.allocations() == 0);
+    REQUIRE(methodResult.as<int>() == 10 * 3 * test2.m_c);
+    REQUIRE(constMethodResult.as<int>() == methodResult.as<int>());
+    REQUIRE(test1.m_c == 10 + 20 + 'a' + 1 + 2 + 3);
+    REQUIRE(test3.m_c == test1.m_c);
+    REQUIRE(result.as<int>() == 10 + test1.m_c);
+}
+
+TEST_CASE("Function_bind") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    reflection->registerFunction("multiArgFunc", &multiArgFunc);
+    auto boundFunc = reflection->getFunction("multiArgFunc").bind<int(int, TestClass, TestClass*, TestClass&)>();
+    TestClass test1(1);
+    TestClass test2(2);
+    TestClass test3(3);
+    REQUIRE(boundFunc(10, test1, &test2, test3) == 11);
+    REQUIRE(test3.m_c == 11);
+    REQUIRE_THROWS(reflection->getFunction("multiArgFunc").bind<int(int, TestClass, TestClass*)>());
+    REQUIRE_THROWS(reflection->getFunction("multiArgFunc").bind<int(int, const TestClass&, TestClass*, TestClass&)>());
+
+    Function method(*reflection, &TestClass::testMethodConst);
+    auto boundMethod = method.bind<int(TestClass&, int, int)>();
+    REQUIRE(boundMethod(test3, 2, 3) == 66);
+    REQUIRE_THROWS(method.bind<int(int, int)>());
+}
+
+static std::string stringArgFunc(const std::string& str, int n) {
+    return str + std::to_string(n);
+}
+
+TEST_CASE("Function_tryInvoke") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& function = reflection->registerFunction("stringArgFunc", &stringArgFunc);
+    auto result = function.tryInvoke("test", 1);
+    REQUIRE(result.hasValue());
+    REQUIRE(result->as<std::string>() == "test1");
+
+    auto wrongArgsNumber = function.tryInvoke("test");
+    REQUIRE(!wrongArgsNumber);
+    REQUIRE(wrongArgsNumber.error().code() == ErrorCode::WrongArgumentsNumber);
+    REQUIRE(wrongArgsNumber.error().message() == "Wrong number of arguments. Expected: 2 Received: 1");
+
+    TestClass test(1);
+    auto noConversion = function.tryInvoke(test, 1);
+    REQUIRE(!noConversion);
+    REQUIRE(noConversion.error().code() == ErrorCode::NoConversion);
+    REQUIRE_THROWS(noConversion.value());
+    REQUIRE_THROWS(function(test, 1));
+
+    Value value(10);
+    REQUIRE(value.tryAs<int>() != nullptr);
+    REQUIRE(value.tryAs<TestClass>() == nullptr);
+}
@@ -0,0 +1,521 @@
+#include <atomic>
+#include <thread>
+#include <catch.h>
+
+#include "Reflection.hpp"
+#include "FrozenReflection.hpp"
+#include "NameTable.hpp"
+#include "PerfectHash.hpp"
+#include "StaticTypeTable.hpp"
+#include "BasicTypesReflection.hpp"
+
+using namespace mojito;
+
+struct BaseLevelClass {};
+struct MiddleLevelClass {};
+struct TopLevelClass {};
+
+static int chainedFunc() {
+    return 10;
+}
+
+TEST_CASE("Reflection chain lookup") {
+    auto baseReflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    auto middleReflection = std::make_shared<Reflection>(baseReflection);
+    auto reflection = std::make_shared<Reflection>(middleReflection);
+    baseReflection->registerType<BaseLevelClass>("BaseLevelClass");
+    middleReflection->registerType<MiddleLevelClass>("MiddleLevelClass");
+
+    REQUIRE(reflection->hasType("std::string"));
+    REQUIRE(reflection->hasType(getTypeId<BaseLevelClass>()));
+    REQUIRE(&reflection->getType("MiddleLevelClass") == &middleReflection->getType("MiddleLevelClass"));
+    REQUIRE(!reflection->hasType("TopLevelClass"));
+    REQUIRE(!reflection->hasType(getTypeId<TopLevelClass>()));
+    REQUIRE(!reflection->hasFunction("chainedFunc"));
+
+    // Registration at any level invalidates cached misses
+    auto generation = baseReflection->generation();
+    baseReflection->registerType<TopLevelClass>("TopLevelClass");
+    baseReflection->registerFunction("chainedFunc", &chainedFunc);
+    REQUIRE(baseReflection->generation() != generation);
+    REQUIRE(reflection->hasType("TopLevelClass"));
+    REQUIRE(reflection->hasType(getTypeId<TopLevelClass>()));
+    REQUIRE(reflection->getFunction("chainedFunc")().as<int>() == 10);
+
+    // Derived levels shadow base ones
+    const auto& type = reflection->registerType<TopLevelClass>("TopLevelClass");
+    REQUIRE(&reflection->getType("TopLevelClass") == &type);
+    REQUIRE(&reflection->getType(getTypeId<TopLevelClass>()) == &type);
+    REQUIRE(&middleReflection->getType("TopLevelClass") == &baseReflection->getType("TopLevelClass"));
+}
+
+TEST_CASE("Reflection lookup filter") {
+    auto baseReflection = std::make_shared<Reflection>();
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    {
+        // Reflections leave the base on destruction, so it doesn't notify them anymore
+        auto temporaryReflection = std::make_shared<Reflection>(baseReflection);
+        REQUIRE(!temporaryReflection->hasFunction("filteredFunc0"));
+    }
+    const int functionsCount = 5000;
+    std::vector<std::string> names;
+    for (int i = 0; i < functionsCount; ++i)
+        names.push_back(concat("filteredFunc", i));
+
+    // Filters of derived reflections grow with names registered in the base, lookups in between see every name
+    int errors = 0;
+    for (int i = 0; i < functionsCount; ++i) {
+        baseReflection->registerFunction(names[i], &chainedFunc);
+        errors += !reflection->hasFunction(names[i]);
+        errors += reflection->hasFunction(concat("missingFunc", i));
+    }
+    for (const auto& name : names)
+        errors += !reflection->hasFunction(name);
+    REQUIRE(errors == 0);
+}
+
+TEST_CASE("Reflection lookup cache") {
+    auto baseReflection = std::make_shared<Reflection>();
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    const auto& baseFunction = baseReflection->registerFunction("cachedFunc", &chainedFunc);
+    REQUIRE(reflection->findFunction(Symbol("cachedFunc")) == &baseFunction);
+    auto cachesBytes = reflection->memoryStats().caches;
+
+    // Registrations outdate cached entries, they are updated in place instead of caching the chain again
+    const int functionsCount = 5000;
+    int errors = 0;
+    for (int i = 0; i < functionsCount; ++i) {
+        baseReflection->registerFunction(concat("uncachedFunc", i), &chainedFunc);
+        errors += reflection->findFunction(Symbol("cachedFunc")) != &baseFunction;
+    }
+    REQUIRE(errors == 0);
+    // Only the lookup filter grows with names of the chain, by a few bytes per name
+    REQUIRE(reflection->memoryStats().caches <= cachesBytes + functionsCount * 16);
+
+    const auto& function = reflection->registerFunction("cachedFunc", &chainedFunc);
+    REQUIRE(reflection->findFunction(Symbol("cachedFunc")) == &function);
+}
+
+struct FirstIndexedClass {};
+struct SecondIndexedClass {};
+struct UnregisteredClass {};
+
+TEST_CASE("Reflection type index") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    const auto& firstType = reflection->registerType<FirstIndexedClass>("FirstIndexedClass");
+    const auto& secondType = reflection->registerType<SecondIndexedClass>("SecondIndexedClass");
+
+    auto firstIndex = getTypeId<FirstIndexedClass>().typeIndex();
+    REQUIRE(firstIndex != 0);
+    REQUIRE(getTypeId<SecondIndexedClass>().typeIndex() != firstIndex);
+    REQUIRE(getTypeId<FirstIndexedClass*>().typeIndex() == firstIndex);
+    REQUIRE(getTypeId<UnregisteredClass>().typeIndex() == 0);
+
+    REQUIRE(&reflection->getType(getTypeId<FirstIndexedClass>()) == &firstType);
+    REQUIRE(&reflection->getType(getTypeId<SecondIndexedClass>()) == &secondType);
+    REQUIRE(&reflection->getType(getTypeId<std::string>()) == &reflection->getType("std::string"));
+    REQUIRE(!reflection->hasType(getTypeId<FirstIndexedClass*>()));
+    REQUIRE(!reflection->hasType(getTypeId<UnregisteredClass>()));
+    REQUIRE(!reflection->hasType(TypeId()));
+    REQUIRE_THROWS(reflection->getType(getTypeId<UnregisteredClass>()));
+
+    // Index is shared by all reflections
+    auto otherReflection = std::make_shared<Reflection>();
+    otherReflection->registerType<FirstIndexedClass>("FirstIndexedClass");
+    REQUIRE(getTypeId<FirstIndexedClass>().typeIndex() == firstIndex);
+    REQUIRE(!otherReflection->hasType(getTypeId<SecondIndexedClass>()));
+}
+
+struct FrozenClass {
+    int value = 5;
+    int twice() const { return value * 2; }
+    int scaled(int factor) const { return value * factor; }
+    std::string scaled(const std::string& suffix) const { return std::to_string(value) + suffix; }
+};
+
+TEST_CASE("Reflection freeze") {
+    auto baseReflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    baseReflection->registerType<BaseLevelClass>("BaseLevelClass");
+    baseReflection->registerFunction("chainedFunc", &chainedFunc);
+    reflection->registerType<FrozenClass>("FrozenClass", [] (Type& type) {
+        type.addConstructor<FrozenClass>()
+            .addFunction("twice", &FrozenClass::twice)
+            .addFunction("scaled", static_cast<int (FrozenClass::*) (int) const>(&FrozenClass::scaled))
+            .addFunction("scaled", static_cast<std::string (FrozenClass::*) (const std::string&) const>(&FrozenClass::scaled))
+            .addField("value", &FrozenClass::value);
+    });
+    for (int i = 0; i < 1000; ++i)
+        reflection->registerFunction(concat("chainedFunc", i), &chainedFunc);
+
+    auto frozen = reflection->freeze();
+    REQUIRE(frozen->hasType("std::string"));
+    REQUIRE(frozen->hasType(getTypeId<BaseLevelClass>()));
+    REQUIRE(!frozen->hasType("TopLevelClass"));
+    REQUIRE(!frozen->hasType(getTypeId<FrozenClass*>()));
+    REQUIRE(&frozen->getType("FrozenClass") == &frozen->getType(getTypeId<FrozenClass>()));
+    REQUIRE(frozen->types().size() == 3);
+    REQUIRE_THROWS(frozen->getType("TopLevelClass"));
+
+    // Registered types don't change, so they are referred to instead of copied
+    REQUIRE(&frozen->getType("FrozenClass") == &reflection->getType("FrozenClass"));
+    const auto& type = frozen->getType("FrozenClass");
+    auto object = type.constructOnStack();
+    REQUIRE(type.function("twice")(object).as<int>() == 10);
+    REQUIRE(type.field("value").getValue(object).as<int>() == 5);
+
+    // Members are copied into the snapshot
+    auto typeId = getTypeId<FrozenClass>();
+    REQUIRE(frozen->method(typeId, "twice")(object).as<int>() == 10);
+    auto scaled = frozen->method(typeId, "scaled");
+    REQUIRE(scaled.size() == 2);
+    REQUIRE(&scaled[0] != &type.function("scaled").overloads()[0]);
+    REQUIRE(scaled(object, 3).as<int>() == 15);
+    REQUIRE(scaled(object, std::string(" items")).as<std::string>() == "5 items");
+    REQUIRE(scaled.tryInvoke(object, 1.5).error().code() == ErrorCode::NoOverload);
+    REQUIRE(!frozen->findMethod(typeId, "value"));
+    REQUIRE(!frozen->findMethod(getTypeId<BaseLevelClass>(), "twice"));
+    REQUIRE_THROWS(frozen->method(typeId, "missing"));
+    REQUIRE(frozen->field(typeId, "value").getValue(object).as<int>() == 5);
+    REQUIRE(&frozen->field(typeId, "value") != &type.field("value"));
+    REQUIRE(frozen->findField(typeId, "twice") == nullptr);
+    REQUIRE_THROWS(frozen->field(getTypeId<BaseLevelClass>(), "value"));
+
+    REQUIRE(frozen->functions().size() == 1001);
+    REQUIRE(frozen->getFunction("chainedFunc")().as<int>() == 10);
+    for (int i = 0; i < 1000; ++i)
+        REQUIRE(frozen->hasFunction(concat("chainedFunc", i)));
+    REQUIRE(!frozen->hasFunction("chainedFunc1000"));
+
+    // Snapshot doesn't change with the reflection
+    reflection->registerType<TopLevelClass>("TopLevelClass");
+    REQUIRE(!frozen->hasType("TopLevelClass"));
+}
+
+static size_t frozenLength(const std::string& text) {
+    return text.size();
+}
+
+TEST_CASE("Reflection freeze concurrent calls") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    reflection->registerFunction("frozenLength", &frozenLength);
+    reflection->registerType<FrozenClass>("FrozenClass", [] (Type& type) {
+        type.addFunction("scaled", static_cast<int (FrozenClass::*) (int) const>(&FrozenClass::scaled))
+            .addFunction("scaled", static_cast<std::string (FrozenClass::*) (const std::string&) const>(&FrozenClass::scaled));
+    });
+    auto frozen = reflection->freeze();
+    const int callsCount = 1000;
+
+    // Arguments are converted through the source reflection, which keeps being extended meanwhile
+    std::atomic<int> errors {0};
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&, i] {
+            // Overloads are resolved with alternating argument types, without a shared cache
+            FrozenClass object;
+            auto scaled = frozen->method(getTypeId<FrozenClass>(), "scaled");
+            for (int call = 0; call < callsCount; ++call) {
+                if (frozen->getFunction("frozenLength")("frozen").as<size_t>() != 6 || !frozen->hasType("std::string"))
+                    ++errors;
+                if ((call + i) % 2 == 0 ? scaled(object, 2).as<int>() != 10 : scaled(object, std::string("!")).as<std::string>() != "5!")
+                    ++errors;
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i)
+        reflection->registerFunction(concat("frozenFunc", i), &chainedFunc);
+    for (auto& caller : callers)
+        caller.join();
+
+    REQUIRE(errors == 0);
+    auto stats = reflection->conversionCacheStats();
+    REQUIRE(stats.hits + stats.misses == 4 * callsCount);
+    REQUIRE(stats.misses <= 4);
+}
+
+struct FirstTableClass {};
+struct SecondTableClass {};
+struct UntabledClass {};
+
+TEST_CASE("Reflection name table") {
+    // Built as the generator does it
+    std::vector<std::string_view> names = { "FirstTableClass", "SecondTableClass", "BaseTableClass" };
+    std::vector<uint64_t> hashes;
+    for (auto name : names)
+        hashes.push_back(typeNameHash(name));
+    PerfectHash perfectHash(hashes);
+    std::vector<std::string_view> slots(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+        slots[perfectHash.slot(hashes[i])] = names[i];
+    NameTable nameTable { perfectHash.displacements().data(), perfectHash.displacements().size(), slots.data(), slots.size() };
+    for (auto name : names)
+        REQUIRE(slots[nameTable.find(name)] == name);
+    REQUIRE(nameTable.find("UntabledClass") == NameTable::NotFound);
+    REQUIRE(NameTable().find("FirstTableClass") == NameTable::NotFound);
+
+    auto baseReflection = std::make_shared<Reflection>();
+    baseReflection->registerType<BaseLevelClass>("BaseTableClass");
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    reflection->registerType<FirstTableClass>("FirstTableClass");
+    reflection->setNameTable(nameTable);
+    // Generated registration may run more than once, the same table is accepted again
+    REQUIRE_NOTHROW(reflection->setNameTable(nameTable));
+    std::vector<std::string_view> slotsCopy(slots);
+    NameTable nameTableCopy { perfectHash.displacements().data(), perfectHash.displacements().size(), slotsCopy.data(), slotsCopy.size() };
+    REQUIRE_NOTHROW(reflection->setNameTable(nameTableCopy));
+    std::swap(slotsCopy[0], slotsCopy[1]);
+    REQUIRE_THROWS_WITH(reflection->setNameTable(nameTableCopy), "A different name table is already set");
+    REQUIRE_THROWS(reflection->setNameTable(NameTable()));
+    reflection->registerType<SecondTableClass>("SecondTableClass");
+    reflection->registerType<UntabledClass>("UntabledClass");
+
+    REQUIRE(reflection->getType("FirstTableClass").typeId() == getTypeId<FirstTableClass>());
+    REQUIRE(reflection->getType("SecondTableClass").typeId() == getTypeId<SecondTableClass>());
+    // Names of the table registered in base reflections and names outside of the table are found as before
+    REQUIRE(reflection->getType("BaseTableClass").typeId() == getTypeId<BaseLevelClass>());
+    REQUIRE(reflection->getType("UntabledClass").typeId() == getTypeId<UntabledClass>());
+    REQUIRE(reflection->findType("MissingTableClass") == nullptr);
+    REQUIRE_FALSE(reflection->hasType("MissingTableClass"));
+}
+
+struct StaticTableClass {
+    int value = 5;
+    int getValue() const { return value; }
+};
+
+struct OtherStaticTableClass {};
+
+namespace {
+
+void addStaticTableClassMembers(Type& type) {
+    type.addConstructor<StaticTableClass>()
+        .addFunction("getValue", &StaticTableClass::getValue)
+        .addField("value", &StaticTableClass::value);
+}
+
+void addOtherStaticTableClassMembers(Type& type) {
+    type.addConstructor<OtherStaticTableClass>();
+}
+
+// As emitted by the generator in static tables mode
+constexpr StaticTypeInfo staticTypes[] = {
+    { "StaticTableClass", &getTypeId<StaticTableClass>, &addStaticTableClassMembers },
+    { "OtherStaticTableClass", &getTypeId<OtherStaticTableClass>, &addOtherStaticTableClassMembers }
+};
+
+constexpr StaticTypeTable staticTypeTable { staticTypes, 2 };
+
+}
+
+TEST_CASE("Reflection static type table") {
+    auto reflection = std::make_shared<Reflection>();
+    auto& registeredType = reflection->registerType<OtherStaticTableClass>("OtherStaticTableClass");
+    reflection->adoptTypeTable(staticTypeTable);
+
+    const auto& type = reflection->getType("StaticTableClass");
+    REQUIRE(type.typeId() == getTypeId<StaticTableClass>());
+    REQUIRE(&reflection->getType(getTypeId<StaticTableClass>()) == &type);
+    auto object = type.constructOnStack();
+    REQUIRE(type.function("getValue")(object).as<int>() == 5);
+    REQUIRE(type.field("value").getValue(object).as<int>() == 5);
+    // Already registered types are kept, members are not added twice
+    REQUIRE(&reflection->getType("OtherStaticTableClass") == &registeredType);
+    REQUIRE(registeredType.constructors().empty());
+    reflection->adoptTypeTable(staticTypeTable);
+    REQUIRE(type.constructors().size() == 1);
+    reflection->adoptTypeTable(StaticTypeTable());
+}
+
+TEST_CASE("Reflection unknown names") {
+    auto baseReflection = std::make_shared<Reflection>();
+    baseReflection->adoptTypeTable(staticTypeTable);
+    auto middleReflection = std::make_shared<Reflection>(baseReflection);
+    auto reflection = std::make_shared<Reflection>(middleReflection);
+    middleReflection->registerType<MiddleLevelClass>("MiddleLevelClass");
+
+    // Names that were never interned are rejected by the filter, only its false positives walk the chain
+    const int namesCount = 1000;
+    auto chainWalks = reflection->chainWalks();
+    int errors = 0;
+    for (int i = 0; i < namesCount; ++i)
+        errors += reflection->findType(concat("UnknownClass", i)) != nullptr;
+    REQUIRE(errors == 0);
+    REQUIRE(reflection->chainWalks() - chainWalks <= namesCount / 100);
+
+    REQUIRE(reflection->findType(std::string("StaticTableClass")) == &baseReflection->getType("StaticTableClass"));
+    REQUIRE(reflection->findType(std::string("MiddleLevelClass")) == &middleReflection->getType("MiddleLevelClass"));
+}
+
+struct FirstLazyClass {};
+struct SecondLazyClass {};
+struct ThirdLazyClass {};
+
+namespace {
+
+std::atomic<int> lazyRegistrationsCount {0};
+
+template <typename TypeT>
+void addLazyClassMembers(Type& type) {
+    ++lazyRegistrationsCount;
+    type.addConstructor<TypeT>();
+}
+
+constexpr StaticTypeInfo lazyTypes[] = {
+    { "FirstLazyClass", &getTypeId<FirstLazyClass>, &addLazyClassMembers<FirstLazyClass> },
+    { "SecondLazyClass", &getTypeId<SecondLazyClass>, &addLazyClassMembers<SecondLazyClass> }
+};
+
+constexpr StaticTypeInfo baseLazyTypes[] = {
+    { "ThirdLazyClass", &getTypeId<ThirdLazyClass>, &addLazyClassMembers<ThirdLazyClass> }
+};
+
+}
+
+TEST_CASE("Reflection lazy registration") {
+    lazyRegistrationsCount = 0;
+    auto baseReflection = std::make_shared<Reflection>();
+    baseReflection->adoptTypeTable(StaticTypeTable { baseLazyTypes, 1 });
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    reflection->adoptTypeTable(StaticTypeTable { lazyTypes, 2 });
+    REQUIRE(lazyRegistrationsCount == 0);
+
+    // Each type is registered once, with its members, even if first lookups race
+    std::vector<std::thread> threads;
+    std::atomic<int> found {0};
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&reflection, &found] {
+            if (reflection->hasType("FirstLazyClass") && reflection->getType("FirstLazyClass").constructors().size() == 1)
+                ++found;
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    REQUIRE(found == 4);
+    REQUIRE(lazyRegistrationsCount == 1);
+
+    REQUIRE(reflection->getType(getTypeId<SecondLazyClass>()).constructors().size() == 1);
+    REQUIRE(lazyRegistrationsCount == 2);
+    REQUIRE(&reflection->getType(Symbol("SecondLazyClass")) == &reflection->getType(getTypeId<SecondLazyClass>()));
+    REQUIRE_FALSE(reflection->hasType("MissingLazyClass"));
+    REQUIRE(lazyRegistrationsCount == 2);
+
+    // Snapshot registers the rest
+    auto frozenReflection = reflection->freeze();
+    REQUIRE(lazyRegistrationsCount == 3);
+    REQUIRE(frozenReflection->getType("ThirdLazyClass").typeId() == getTypeId<ThirdLazyClass>());
+    REQUIRE(&reflection->getType("ThirdLazyClass") == &baseReflection->getType("ThirdLazyClass"));
+    REQUIRE(lazyRegistrationsCount == 3);
+}
+
+TEST_CASE("Reflection concurrent registration") {
+    auto baseReflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    auto reflection = std::make_shared<Reflection>(baseReflection);
+    const int functionsCount = 500;
+    std::vector<Symbol> names;
+    for (int i = 0; i < functionsCount; ++i)
+        names.emplace_back(concat("concurrentFunc", i));
+
+    std::atomic<bool> done {false};
+    std::atomic<int> errors {0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                // Once found, an entry is never lost
+                int found = 0;
+                for (auto name : names) {
+                    if (reflection->hasFunction(name))
+                        ++found;
+                    else if (found == functionsCount)
+                        ++errors;
+                }
+                if (!reflection->hasType("std::string"))
+                    ++errors;
+            }
+        });
+    }
+    for (int i = 0; i < functionsCount; ++i) {
+        auto& level = i % 2 == 0 ? reflection : baseReflection;
+        level->registerFunction(names[i].str(), &chainedFunc);
+    }
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    REQUIRE(errors == 0);
+    for (auto name : names)
+        REQUIRE(reflection->getFunction(name)().as<int>() == 10);
+    REQUIRE(&reflection->registerFunction("concurrentFunc0", &chainedFunc) == &reflection->getFunction("concurrentFunc0"));
+}
+
+struct PublishedClass {
+    int method() const { return 1; }
+};
+
+TEST_CASE("Reflection publishes complete types") {
+    auto reflection = std::make_shared<Reflection>();
+    const int typesCount = 100;
+    const int methodsCount = 50;
+    std::vector<Symbol> names;
+    for (int i = 0; i < typesCount; ++i)
+        names.emplace_back(concat("PublishedClass", i));
+    Symbol lastMethod(concat("method", methodsCount - 1));
+
+    std::atomic<bool> done {false};
+    std::atomic<int> errors {0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (auto name : names) {
+                if (auto type = reflection->findType(name))
+                    errors += !type->findMethodHandle(lastMethod);
+            }
+        }
+    });
+    for (auto name : names) {
+        reflection->registerType<PublishedClass>(name.str(), [] (Type& type) {
+            for (int i = 0; i < methodsCount; ++i)
+                type.addFunction(concat("method", i), &PublishedClass::method);
+        });
+    }
+    done = true;
+    reader.join();
+    REQUIRE(errors == 0);
+
+    // Registering the name again doesn't add members to the published type
+    int calls = 0;
+    const auto& type = reflection->registerType<PublishedClass>("PublishedClass0", [&calls] (Type&) { ++calls; });
+    REQUIRE(calls == 0);
+    REQUIRE(&type == reflection->findType(names[0]));
+    REQUIRE(type.findMethodHandle(lastMethod));
+}
+
+struct FirstMemoryClass {};
+struct SecondMemoryClass {};
+
+TEST_CASE("Reflection memory stats") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    auto emptyStats = reflection->memoryStats();
+    REQUIRE(emptyStats.types == 0);
+    REQUIRE(emptyStats.functions == 0);
+    REQUIRE(emptyStats.perType.empty());
+    REQUIRE(emptyStats.symbols > 0);
+
+    reflection->registerType<FirstMemoryClass>("FirstMemoryClass", [] (Type& type) {
+        type.addConstructor<FirstMemoryClass>();
+    });
+    reflection->registerType<SecondMemoryClass>("SecondMemoryClass");
+    reflection->registerFunction("memoryFunc", &chainedFunc);
+    auto stats = reflection->memoryStats();
+    REQUIRE(stats.perType.size() == 2);
+    REQUIRE(stats.perType[0].first == Symbol("FirstMemoryClass"));
+    REQUIRE(stats.perType[0].second.constructors > 0);
+    REQUIRE(stats.perType[1].second.constructors == 0);
+    REQUIRE(stats.types == stats.perType[0].second.total() + stats.perType[1].second.total());
+    REQUIRE(stats.functions == sizeof(Function));
+    REQUIRE(stats.registry > emptyStats.registry);
+    REQUIRE(stats.typeNames == typeName<FirstMemoryClass>().size() + typeName<SecondMemoryClass>().size());
+    REQUIRE(stats.total() > emptyStats.total());
+
+    REQUIRE(reflection->hasType("FirstMemoryClass"));
+    REQUIRE(reflection->memoryStats().caches > stats.caches);
+}
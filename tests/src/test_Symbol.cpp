@@ -0,0 +1,45 @@
+#include <catch.h>
+
+#include "Reflection.hpp"
+#include "BasicTypesReflection.hpp"
+#include "AllocationCounter.hpp"
+
+using namespace mojito;
+
+struct SymbolTestClass {
+    int value = 0;
+};
+
+TEST_CASE("Symbol interning") {
+    std::string name = "symbolInterningTest";
+    REQUIRE(Symbol::find(name).empty());
+    Symbol symbol(name);
+    REQUIRE(!symbol.empty());
+    REQUIRE(symbol == Symbol(std::string_view("symbolInterningTest")));
+    REQUIRE(symbol == Symbol::find(name));
+    REQUIRE(symbol != Symbol("symbolInterningTest2"));
+    REQUIRE(symbol.str() == name);
+    REQUIRE(symbol.str().data() == Symbol(name).str().data());
+    REQUIRE(symbol.hash() == std::hash<std::string_view>()(name));
+}
+
+TEST_CASE("Symbol lookup") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    reflection->registerType<SymbolTestClass>("SymbolTestClass", [] (Type& type) {
+        type.addField("value", &SymbolTestClass::value);
+    });
+
+    REQUIRE(reflection->hasType("std::string"));
+    REQUIRE(reflection->hasType(Symbol("SymbolTestClass")));
+    REQUIRE(!reflection->hasType("SymbolTestClass2"));
+    REQUIRE_THROWS(reflection->getType("SymbolTestClass2"));
+
+    std::string_view name = "SymbolTestClass";
+    reflection->getType(name); // Fills the lookup cache
+    AllocationCounter allocationCounter;
+    const auto& type = reflection->getType(name);
+    const auto& field = type.field("value");
+    REQUIRE(allocationCounter.allocations() == 0);
+    REQUIRE(&type == &reflection->getType(Symbol(name)));
+    REQUIRE(&field == &type.field(Symbol("value")));
+}
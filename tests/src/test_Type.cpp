@@ -48,11 +48,12 @@ static void testFunc(std::string str) {
 TEST_CASE("Type") {
     auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
 
-    auto type = reflection->registerType<TestClass>("TestClass")
-            .addConstructor<TestClass, int>()
+    const auto& type = reflection->registerType<TestClass>("TestClass", [] (Type& type) {
+        type.addConstructor<TestClass, int>()
             .addFunction("testMethod", &TestClass::testMethod)
             .addFunction("testMethodConst", &TestClass::testMethod)
             .addFunction("c", &TestClass::c);
+    });
 
     TestClass testClass(30);
     REQUIRE(type.function("testMethod")(testClass, 10, 20).as<int>() == 6000);
@@ -68,8 +69,8 @@ TEST_CASE("Type") {
 TEST_CASE("Type constructors") {
     auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
 
-    auto type = reflection->registerType<TestClass>("TestClass")
-            .addConstructor<TestClass, int>()
+    const auto& type = reflection->registerType<TestClass>("TestClass", [] (Type& type) {
+        type.addConstructor<TestClass, int>()
             .addFunction("testMethod", &TestClass::testMethod)
             .addFunction("testMethodConst", &TestClass::testMethodConst)
             .addFunction("testMethodConstRefArg", &TestClass::testMethodConstRefArg)
@@ -77,11 +78,13 @@ TEST_CASE("Type constructors") {
             .addFunction("newArray", &TestClass::newArray)
             .addFunction("c", &TestClass::c)
             .addField("m_c", &TestClass::m_c);
-    REQUIRE(type.functionMap().find("testMethod") != type.functionMap().end());
+    });
+    REQUIRE(type.findMethodHandle("testMethod"));
 
-    auto typeSharedPtr = reflection->registerType<std::shared_ptr<TestClass>>("std::shared_ptr<TestClass>")
-            .addConstructor<std::shared_ptr<TestClass>, TestClass*>()
+    const auto& typeSharedPtr = reflection->registerType<std::shared_ptr<TestClass>>("std::shared_ptr<TestClass>", [] (Type& type) {
+        type.addConstructor<std::shared_ptr<TestClass>, TestClass*>()
             .addFunction<std::shared_ptr<TestClass>, TestClass*>("get", [](auto v) { return v.get(); });
+    });
 
     auto rawPointer1 = type.constructOnHeap(10);
     auto value = typeSharedPtr.constructOnStack(rawPointer1);
@@ -100,3 +103,203 @@ TEST_CASE("Type constructors") {
     REQUIRE(arrayPtr.as<int*>()[1] == 1);
     delete arrayPtr.as<int*>();
 }
+
+TEST_CASE("Type conversion cache") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    const auto& type = reflection->registerType<TestClass>("TestClass", [] (Type& type) {
+        type.addConstructor<TestClass, int>()
+            .addFunction("testMethodConstRefArg", &TestClass::testMethodConstRefArg);
+    });
+
+    TestClass testClass(10);
+    REQUIRE(type.function("testMethodConstRefArg")(testClass, "first").as<std::string>() == "first");
+    REQUIRE(reflection->conversionCacheStats().misses == 1);
+    REQUIRE(reflection->conversionCacheStats().hits == 0);
+    REQUIRE(type.function("testMethodConstRefArg")(testClass, "second").as<std::string>() == "second");
+    REQUIRE(reflection->conversionCacheStats().misses == 1);
+    REQUIRE(reflection->conversionCacheStats().hits == 1);
+}
+
+struct MultiConstructorClass {
+    MultiConstructorClass(int value) : intValue(value) {}
+    MultiConstructorClass(float value) : floatValue(value) {}
+    MultiConstructorClass(const std::string* value) : stringValue(*value) {}
+    MultiConstructorClass(const char* value) : stringValue(value) {}
+
+    int intValue = 0;
+    float floatValue = 0;
+    std::string stringValue;
+};
+
+TEST_CASE("Type exact constructor match") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    const auto& type = reflection->registerType<MultiConstructorClass>("MultiConstructorClass", [] (Type& type) {
+        type.addConstructor<MultiConstructorClass, int>()
+            .addConstructor<MultiConstructorClass, float>()
+            .addConstructor<MultiConstructorClass, const std::string*>()
+            .addConstructor<MultiConstructorClass, const char*>();
+    });
+
+    REQUIRE(type.constructOnStack(10).as<MultiConstructorClass>().intValue == 10);
+    REQUIRE(type.constructOnStack(2.5f).as<MultiConstructorClass>().floatValue == 2.5f);
+    const char* str = "test";
+    REQUIRE(type.constructOnStack(str).as<MultiConstructorClass>().stringValue == "test");
+}
+
+struct ReferenceConstructorClass {
+    ReferenceConstructorClass(int value) : intValue(value) {}
+    ReferenceConstructorClass(const std::string& value) : stringValue(value) {}
+
+    int intValue = 0;
+    std::string stringValue;
+};
+
+TEST_CASE("Type constructor match by decayed types") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    // The compatible match search compares qualifiers only, so it would pick the int constructor registered first.
+    // The string one can only be found through the index.
+    const auto& type = reflection->registerType<ReferenceConstructorClass>("ReferenceConstructorClass", [] (Type& type) {
+        type.addConstructor<ReferenceConstructorClass, int>()
+            .addConstructor<ReferenceConstructorClass, const std::string&>();
+    });
+
+    std::string str = "test";
+    REQUIRE(type.constructOnStack(str).as<ReferenceConstructorClass>().stringValue == "test");
+    REQUIRE(type.tryConstructOnStack(str)->as<ReferenceConstructorClass>().stringValue == "test");
+    const std::string constStr = "const";
+    REQUIRE(type.constructOnStack(constStr).as<ReferenceConstructorClass>().stringValue == "const");
+    int value = 10;
+    REQUIRE(type.constructOnStack(value).as<ReferenceConstructorClass>().intValue == 10);
+}
+
+struct OverloadedClass {
+    int overloaded(int value) const { return value * 2; }
+    float overloaded(float value) const { return value / 2; }
+    std::string overloaded(const std::string& value) const { return value + value; }
+    double overloaded(double value) const { return value * 3; }
+};
+
+TEST_CASE("Type overloaded functions") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    const auto& type = reflection->registerType<OverloadedClass>("OverloadedClass", [] (Type& type) {
+        type.addFunction("overloaded", static_cast<int (OverloadedClass::*) (int) const>(&OverloadedClass::overloaded))
+            .addFunction("overloaded", static_cast<float (OverloadedClass::*) (float) const>(&OverloadedClass::overloaded))
+            .addFunction("overloaded", static_cast<std::string (OverloadedClass::*) (const std::string&) const>(&OverloadedClass::overloaded))
+            .addFunction("overloaded", static_cast<double (OverloadedClass::*) (double) const>(&OverloadedClass::overloaded));
+    });
+
+    OverloadedClass object;
+    REQUIRE(type.function("overloaded").size() == 4);
+    REQUIRE(type.function("overloaded")(object, 10).as<int>() == 20);
+    REQUIRE(type.function("overloaded")(object, 10).as<int>() == 20);
+    REQUIRE(type.function("overloaded")(object, 5.0f).as<float>() == 2.5f);
+    REQUIRE(type.function("overloaded")(object, std::string("ab")).as<std::string>() == "abab");
+    // Exact match is preferred to the compatible overloads registered before it
+    REQUIRE(type.function("overloaded")(object, 1.0).as<double>() == 3.0);
+    // Only the string overload can take the argument, by conversion
+    REQUIRE(type.function("overloaded")(object, "cd").as<std::string>() == "cdcd");
+    const std::string constStr("ef");
+    REQUIRE(type.function("overloaded")(object, constStr).as<std::string>() == "efef");
+    REQUIRE(type.function("overloaded").tryInvoke(object, 'c').error().code() == ErrorCode::NoOverload);
+    REQUIRE(type.function("overloaded").bind<float(OverloadedClass&, float)>()(object, 3.0f) == 1.5f);
+}
+
+TEST_CASE("Type inline functions with captures") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    int factor = 3;
+    const int* factorPtr = &factor;
+    const auto& type = reflection->registerType<TestClass>("TestClass", [factor, factorPtr] (Type& type) {
+        type.addFunction<TestClass, int>("scaled", [factor] (TestClass& object) { return object.m_c * factor; })
+            .addFunction<TestClass, int, int>("scaledBy", [factorPtr] (TestClass& object, int value) { return object.m_c * value * *factorPtr; });
+    });
+
+    TestClass testClass(10);
+    REQUIRE(type.function("scaled")(testClass).as<int>() == 30);
+    REQUIRE(type.function("scaledBy")(testClass, 2).as<int>() == 60);
+    factor = 5;
+    REQUIRE(type.function("scaledBy").bind<int(TestClass&, int)>()(testClass, 2) == 100);
+    REQUIRE(type.function("scaled").bind<int(TestClass&)>()(testClass) == 30);
+}
+
+TEST_CASE("Type tryConstruct") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    const auto& type = reflection->registerType<TestClass>("TestClass", [] (Type& type) {
+        type.addConstructor<TestClass, int>()
+            .addFunction("testMethodConstRefArg", &TestClass::testMethodConstRefArg);
+    });
+
+    auto value = type.tryConstructOnStack(10);
+    REQUIRE(value.hasValue());
+    REQUIRE(value->as<TestClass>().m_c == 10);
+    auto noConstructor = type.tryConstructOnStack(&type);
+    REQUIRE(noConstructor.error().code() == ErrorCode::NoConstructor);
+
+    TestClass testClass(10);
+    REQUIRE(type.function("testMethodConstRefArg").tryInvoke(testClass, "test")->as<std::string>() == "test");
+    REQUIRE(type.function("testMethodConstRefArg").tryInvoke(testClass, 10).error().code() == ErrorCode::NoConversion);
+}
+
+TEST_CASE("Type member handles") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+
+    MethodHandle testMethod;
+    FieldHandle field;
+    const auto& type = reflection->registerType<TestClass>("TestClass", [&testMethod, &field] (Type& type) {
+        type.addConstructor<TestClass, int>()
+            .addFunction("testMethod", &TestClass::testMethod)
+            .addField("m_c", &TestClass::m_c);
+        testMethod = type.methodHandle("testMethod");
+        field = type.fieldHandle("m_c");
+        type.addFunction("c", &TestClass::c);
+        // Handles stay valid while members storage grows
+        for (int i = 0; i < 100; ++i)
+            type.addFunction(concat("c", i), &TestClass::c);
+    });
+    REQUIRE(testMethod == type.methodHandle("testMethod"));
+    REQUIRE(type.functionMap().size() == 102);
+    REQUIRE(type.functionMap()[101].first == Symbol("c99"));
+    REQUIRE(type.findMethodHandle("c"));
+    REQUIRE(!type.findMethodHandle("unknown"));
+    REQUIRE(!type.findFieldHandle("unknown"));
+    REQUIRE_THROWS(type.methodHandle("unknown"));
+    REQUIRE_THROWS(type.fieldHandle("unknown"));
+
+    TestClass testClass(10);
+    ValueRef ref(testClass);
+    REQUIRE(testMethod(testClass, 2, 3).as<int>() == 60);
+    REQUIRE(field.typeId() == getTypeId<int>());
+    field.setValue(ref, 20);
+    REQUIRE(field.getValue(ref).as<int>() == 20);
+    REQUIRE(testMethod.tryInvoke(testClass, 2, 3)->as<int>() == 120);
+}
+
+TEST_CASE("Type memory stats") {
+    auto reflection = std::make_shared<Reflection>(BasicTypesReflection::instance().reflection());
+    reflection->registerType<TestClass>("TestClass", [] (Type& type) {
+        auto emptyStats = type.memoryStats();
+        REQUIRE(emptyStats.object >= sizeof(Type));
+        REQUIRE(emptyStats.constructors == 0);
+        REQUIRE(emptyStats.methods == 0);
+        REQUIRE(emptyStats.fields == 0);
+        REQUIRE(emptyStats.total() == emptyStats.object + emptyStats.indices);
+
+        type.addConstructor<TestClass, int>()
+            .addFunction("testMethod", &TestClass::testMethod)
+            .addField("m_c", &TestClass::m_c);
+        auto stats = type.memoryStats();
+        REQUIRE(stats.constructors >= sizeof(Constructor));
+        REQUIRE(stats.methods >= sizeof(Function));
+        REQUIRE(stats.fields >= sizeof(Field));
+        REQUIRE(stats.indices > 0);
+
+        // Overloads take space in the existing overload set
+        type.addFunction("testMethod", &TestClass::testMethodConst);
+        REQUIRE(type.memoryStats().methods >= stats.methods + sizeof(Function));
+        REQUIRE(type.memoryStats().fields == stats.fields);
+    });
+}
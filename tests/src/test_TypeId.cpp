@@ -0,0 +1,75 @@
+#include <array>
+#include <catch.h>
+
+#include "TypeId.hpp"
+
+using namespace mojito;
+
+namespace typeIdTest {
+    struct NamedClass {};
+}
+
+static_assert(typeName<int>() == "int", "Type name should be parsed at compile time");
+
+TEST_CASE("TypeId names") {
+    REQUIRE(getTypeId<int>().name() == "int");
+    REQUIRE(getTypeId<typeIdTest::NamedClass>().name() == "typeIdTest::NamedClass");
+    REQUIRE(getTypeName(getTypeId<typeIdTest::NamedClass*>()) == "typeIdTest::NamedClass*");
+    REQUIRE(getTypeName(getTypeId<const typeIdTest::NamedClass&>()) == "const typeIdTest::NamedClass");
+    REQUIRE(getTypeName(getTypeId<const int*>()) == "const int*");
+    REQUIRE(TypeId().name().empty());
+    REQUIRE(sizeof(TypeId) == sizeof(void*));
+}
+
+static bool endsWith(std::string_view name, std::string_view suffix) {
+    return name.size() >= suffix.size() && name.substr(name.size() - suffix.size()) == suffix;
+}
+
+// Compilers differ in spacing, "int [3]" for gcc and "int[3]" for clang
+TEST_CASE("TypeId array names") {
+    auto arrayName = typeName<int[3]>();
+    REQUIRE(arrayName.substr(0, 3) == "int");
+    REQUIRE(endsWith(arrayName, "[3]"));
+    auto nestedName = typeName<std::array<int, 3>[2]>();
+    REQUIRE(nestedName.substr(0, 15) == "std::array<int,");
+    REQUIRE(endsWith(nestedName, "[2]"));
+    REQUIRE(nestedName.find("3>") != std::string_view::npos);
+}
+
+namespace typeIdTest {
+    struct PersistedClass {};
+}
+
+TEST_CASE("TypeId stable hash") {
+    static_assert(typeNameHash("int") == 0x2b9fff192bd4c83eull, "FNV-1a hash of the name");
+    auto typeId = getTypeId<typeIdTest::PersistedClass*>();
+    REQUIRE(typeId.stableHash() == typeNameHash("typeIdTest::PersistedClass"));
+    REQUIRE(typeId.stableHash() == getTypeId<typeIdTest::PersistedClass>().stableHash());
+    REQUIRE(!TypeId::findByStableHash(typeNameHash("typeIdTest::UnknownClass")).isValid());
+
+    registerStableTypeId(typeId);
+    REQUIRE(TypeId::findByStableHash(typeId.stableHash()) == getTypeId<typeIdTest::PersistedClass>());
+    REQUIRE_NOTHROW(registerStableTypeId(getTypeId<typeIdTest::PersistedClass>()));
+}
+
+TEST_CASE("TypeId stable hash collision") {
+    // Slots as getTypeId defines them, with names forced onto the same hash
+    static TypeSlot firstSlot { {0}, "typeIdTest::FirstCollidingClass", typeNameHash("typeIdTest::CollidingClass") };
+    static TypeSlot secondSlot { {0}, "typeIdTest::SecondCollidingClass", typeNameHash("typeIdTest::CollidingClass") };
+    registerStableTypeSlot(&firstSlot);
+    REQUIRE_NOTHROW(registerStableTypeSlot(&firstSlot));
+    REQUIRE_THROWS_WITH(registerStableTypeSlot(&secondSlot),
+                        "Stable hash collision of types typeIdTest::FirstCollidingClass and typeIdTest::SecondCollidingClass");
+    REQUIRE(TypeId::findByStableHash(typeNameHash("typeIdTest::CollidingClass")).name() == "typeIdTest::FirstCollidingClass");
+}
+
+TEST_CASE("TypeId stable slots of modules") {
+    // Slots of the same type, as two modules not sharing template statics define them
+    static TypeSlot firstModuleSlot { {0}, "typeIdTest::ModuleClass", typeNameHash("typeIdTest::ModuleClass") };
+    static TypeSlot secondModuleSlot { {0}, "typeIdTest::ModuleClass", typeNameHash("typeIdTest::ModuleClass") };
+    auto firstSlot = canonicalTypeSlot(&firstModuleSlot);
+    auto secondSlot = canonicalTypeSlot(&secondModuleSlot);
+    REQUIRE(firstSlot == &firstModuleSlot);
+    REQUIRE(secondSlot == firstSlot);
+    REQUIRE(TypeId::findByStableHash(typeNameHash("typeIdTest::ModuleClass")).name() == "typeIdTest::ModuleClass");
+}
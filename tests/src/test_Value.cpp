@@ -0,0 +1,75 @@
+#include <catch.h>
+
+#include "Value.hpp"
+#include "AllocationCounter.hpp"
+
+using namespace mojito;
+
+struct LargeTestClass {
+    int values[16] = {};
+};
+
+static bool isInside(const void* pointer, const Value& value) {
+    auto begin = reinterpret_cast<const char*>(&value);
+    return pointer >= begin && pointer < begin + sizeof(Value);
+}
+
+TEST_CASE("Value_inlineStorage") {
+    AllocationCounter allocationCounter;
+    Value value(10);
+    Value copy(value);
+    Value moved(std::move(copy));
+    Value pointer(&value);
+    REQUIRE(value.as<int>() == 10);
+    REQUIRE(moved.as<int>() == 10);
+    REQUIRE(pointer.as<Value*>() == &value);
+    REQUIRE(isInside(value.voidPointer(), value));
+    REQUIRE(isInside(moved.voidPointer(), moved));
+    REQUIRE(allocationCounter.allocations() == 0);
+}
+
+TEST_CASE("Value_heapStorage") {
+    LargeTestClass large;
+    large.values[15] = 15;
+    Value value(large);
+    Value copy(value);
+    REQUIRE(!isInside(value.voidPointer(), value));
+    REQUIRE(copy.as<LargeTestClass>().values[15] == 15);
+    REQUIRE(Value(new int(20), getTypeId<int>()).as<int>() == 20);
+}
+
+TEST_CASE("Value_size") {
+    // Value pointer, type id, pointer to shared operations table and the two word inline buffer
+    REQUIRE(sizeof(Value) == 5 * sizeof(void*));
+    REQUIRE(sizeof(Value) == 3 * sizeof(void*) + Value::BufferSize);
+    std::vector<Value> row { Value(1), Value(2.0), Value(LargeTestClass()) };
+    auto rowCopy = row;
+    REQUIRE(rowCopy[0].as<int>() == 1);
+    REQUIRE(rowCopy[1].as<double>() == 2.0);
+}
+
+TEST_CASE("Value_move") {
+    Value large(LargeTestClass{});
+    auto largePtr = large.voidPointer();
+    Value inlineValue(10);
+    AllocationCounter allocationCounter;
+    Value movedLarge(std::move(large));
+    Value movedInline(std::move(inlineValue));
+    REQUIRE(allocationCounter.allocations() == 0);
+    REQUIRE(movedLarge.voidPointer() == largePtr);
+    REQUIRE(large.voidPointer() == nullptr);
+    REQUIRE(movedInline.as<int>() == 10);
+    REQUIRE(inlineValue.voidPointer() == nullptr);
+
+    movedInline = std::move(movedLarge);
+    REQUIRE(movedInline.voidPointer() == largePtr);
+    REQUIRE(movedInline.typeId() == getTypeId<LargeTestClass>());
+    REQUIRE(movedLarge.voidPointer() == nullptr);
+
+    std::vector<Value> values;
+    values.emplace_back(LargeTestClass{});
+    auto firstPtr = values.front().voidPointer();
+    values.emplace_back(LargeTestClass{});
+    values.emplace_back(LargeTestClass{});
+    REQUIRE(values.front().voidPointer() == firstPtr);
+}